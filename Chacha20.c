@@ -2,8 +2,9 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <string.h>
-#include <limits.h>
-#include <x86intrin.h> // __rdtsc()
+#include "chacha20.h"
+#include "multiversion.h"
+#include "cycle_timer.h"
 
 typedef uint8_t  u8;
 typedef uint32_t u32;
@@ -43,13 +44,18 @@ static inline void store32_le(u8 *b, u32 v) {
     b[3] = (u8)(v >> 24);
 }
 
+/* Set by the demo main() to print the state dumps; library callers leave it off */
+int chacha20_trace = 0;
+
 /* The ChaCha20 block function — prints initial/state/output same as original */
 void chacha20_block(u32 out[16], const u32 in[16]) {
     u32 state[16];
     for (int i = 0; i < 16; ++i) state[i] = in[i];
 
-    printf("Initial state:\n");
-    print_state(state);
+    if (chacha20_trace) {
+        printf("Initial state:\n");
+        print_state(state);
+    }
 
     /* 20 rounds -> 10 double-rounds */
     for (int i = 0; i < 10; ++i) {
@@ -65,13 +71,17 @@ void chacha20_block(u32 out[16], const u32 in[16]) {
         QR(state[3], state[4], state[9],  state[14]);
     }
 
-    printf("State after 20 rounds:\n");
-    print_state(state);
+    if (chacha20_trace) {
+        printf("State after 20 rounds:\n");
+        print_state(state);
+    }
 
     for (int i = 0; i < 16; ++i) out[i] = state[i] + in[i];
 
-    printf("Output after adding state with input:\n");
-    print_state(out);
+    if (chacha20_trace) {
+        printf("Output after adding state with input:\n");
+        print_state(out);
+    }
 }
 
 /* initialize chacha20 state from key (32), nonce (12) and counter */
@@ -85,6 +95,7 @@ void initialize_state(u32 st[16], const u8 key[32], const u8 nonce[12], u32 coun
 }
 
 /* encrypt in-place: plaintext -> ciphertext (separate buffers) */
+CRYPTO_KERNEL
 void chacha20_encrypt(const u8 *pt, u8 *ct, size_t len, const u8 key[32], const u8 nonce[12], u32 counter) {
     u32 st[16], ks[16];
     size_t off = 0;
@@ -106,6 +117,7 @@ void chacha20_encrypt(const u8 *pt, u8 *ct, size_t len, const u8 key[32], const
     }
 }
 
+#ifndef CRYPTO_NO_MAIN
 int main(void) {
     u8 key[32] = {
         0x00,0x01,0x02,0x03,0x04,0x05,0x06,0x07,
@@ -128,26 +140,25 @@ int main(void) {
         0x74,0x2e
     };
 
+    chacha20_trace = 1;
     size_t len = sizeof plaintext;
     u8 ciphertext[sizeof plaintext];
     u8 decrypted[sizeof plaintext];
 
-    unsigned long long min_cycles = ULLONG_MAX, max_cycles = 0, total_cycles = 0;
-    unsigned long long start, end;
+    CT_STATS stats;
     int trials = 1;
 
+    ct_init();
+    ct_stats_reset(&stats);
     for (int t = 0; t < trials; ++t) {
-        start = __rdtsc();
+        uint64_t start = ct_start();
         chacha20_encrypt(plaintext, ciphertext, len, key, nonce, 1);
         chacha20_encrypt(ciphertext, decrypted, len, key, nonce, 1);
-        end = __rdtsc();
-        unsigned long long cyc = end - start;
-        if (cyc < min_cycles) min_cycles = cyc;
-        if (cyc > max_cycles) max_cycles = cyc;
-        total_cycles += cyc;
+        uint64_t end = ct_stop();
+        ct_stats_add(&stats, ct_elapsed(start, end));
     }
 
-    double avg_cycles = (double)total_cycles / (double)trials;
+    double avg_cycles = ct_stats_avg(&stats);
 
     /* Print results in same order/format as original */
     printf("Plaintext:  %s\n", (char*)plaintext);
@@ -164,8 +175,10 @@ int main(void) {
         printf("Decryption failed: plaintext does not match decrypted text.\n");
 
     printf("Average clock cycles: %.2f\n", avg_cycles);
-    printf("Minimum clock cycles: %llu\n", min_cycles);
-    printf("Maximum clock cycles: %llu\n", max_cycles);
+    printf("Minimum clock cycles: %llu\n", (unsigned long long)stats.min);
+    printf("Maximum clock cycles: %llu\n", (unsigned long long)stats.max);
+    ct_csv_report("chacha20", "encrypt+decrypt", len, &stats, NULL);
 
     return 0;
 }
+#endif /* CRYPTO_NO_MAIN */
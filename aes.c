@@ -2,6 +2,8 @@
 #include <stdint.h>
 #include <string.h>
 #include <stdlib.h>
+#include "aes.h"
+#include "multiversion.h"
 
 // AES S-box
 static const uint8_t sbox[256] = {
@@ -133,6 +135,7 @@ void AES_decrypt(const uint8_t* in,uint8_t* out,const uint8_t* rk){
 }
 
 // ---------- ECB encrypt/decrypt multiple blocks ----------
+CRYPTO_KERNEL
 void AES_ECB_encrypt(const uint8_t* pt,int len,const uint8_t* rk,uint8_t* ct){
     int blocks=(len+15)/16; uint8_t b[16];
     for(int i=0;i<blocks;i++){
@@ -142,6 +145,7 @@ void AES_ECB_encrypt(const uint8_t* pt,int len,const uint8_t* rk,uint8_t* ct){
     }
 }
 
+CRYPTO_KERNEL
 void AES_ECB_decrypt(const uint8_t* ct,int len,const uint8_t* rk,uint8_t* pt){
     int blocks=len/16; uint8_t b[16];
     for(int i=0;i<blocks;i++){
@@ -155,6 +159,7 @@ void hex2bytes(const char* h,uint8_t* b){for(int i=0;i<16;i++) sscanf(h+2*i,"%2h
 void print_hex(const uint8_t* b,int len){for(int i=0;i<len;i++) printf("%02x",b[i]); printf("\n");}
 
 // ---------- Main ----------
+#ifndef CRYPTO_NO_MAIN
 int main(){
     uint8_t key[16],rk[176];
     uint8_t plaintext[16],ciphertext[16],decrypted[16];
@@ -200,3 +205,4 @@ int main(){
     return 0;
 }
 
+#endif /* CRYPTO_NO_MAIN */
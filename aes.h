@@ -0,0 +1,18 @@
+// aes.h
+// AES-128 block cipher (aes.c): key expansion, single-block and ECB mode.
+
+#ifndef AES_H
+#define AES_H
+
+#include <stdint.h>
+
+#define AES_BLOCK_SIZE   16
+#define AES_ROUNDKEY_LEN 176   // 11 round keys x 16 bytes
+
+void KeyExpansion(const uint8_t* key,uint8_t* roundKeys);
+void AES_encrypt(const uint8_t* in,uint8_t* out,const uint8_t* rk);
+void AES_decrypt(const uint8_t* in,uint8_t* out,const uint8_t* rk);
+void AES_ECB_encrypt(const uint8_t* pt,int len,const uint8_t* rk,uint8_t* ct);
+void AES_ECB_decrypt(const uint8_t* ct,int len,const uint8_t* rk,uint8_t* pt);
+
+#endif /* AES_H */
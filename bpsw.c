@@ -0,0 +1,103 @@
+// bpsw.c
+// Baillie-PSW primality test (see primality.h): trial division below 2^16,
+// a strong probable-prime test to base 2, then a strong Lucas test with
+// Selfridge's parameters (P = 1, Q = (1 - D) / 4). No composite is known to
+// pass both halves, and none exists below 2^64.
+
+#include <stdlib.h>
+#include <gmp.h>
+
+#include "primality.h"
+#include "trial_div.h"
+
+/* Selfridge method A: first D in 5, -7, 9, -11, ... with (D/n) = -1.
+   Returns 0 if a D shares a factor with n or n is a square (no such D). */
+static long lucas_selfridge(const mpz_t n, mpz_t t) {
+    long D = 5;
+    for (int i = 0; ; i++) {
+        mpz_set_si(t, D);
+        int j = jacobi_symbol(t, n);
+        if (j == -1) break;
+        // n > 2^64 here, so (D/n) = 0 means a proper common factor
+        if (j == 0 || (i == 8 && mpz_perfect_square_p(n))) {
+            D = 0;
+            break;
+        }
+        D = D > 0 ? -(D + 2) : -D + 2;
+    }
+    return D;
+}
+
+/* x = x / 2 mod n for odd n */
+static void lucas_half(mpz_t x, const mpz_t n) {
+    mpz_mod(x, x, n);
+    if (mpz_odd_p(x)) mpz_add(x, x, n);
+    mpz_fdiv_q_2exp(x, x, 1);
+}
+
+/* Strong Lucas probable prime: with n + 1 = d * 2^s, d odd,
+   U_d == 0 or V_(d * 2^r) == 0 (mod n) for some 0 <= r < s */
+static int lucas_strong(const mpz_t n, long D, PRIMALITY_CTX *c) {
+    long Q = (1 - D) / 4;
+    mpz_ptr d = c->d, U = c->U, V = c->V, Qk = c->Qk, t = c->t;
+
+    mpz_add_ui(d, n, 1);
+    mp_bitcnt_t s = mpz_scan1(d, 0);
+    mpz_fdiv_q_2exp(d, d, s);
+
+    // left-to-right over d, starting from U_1 = 1, V_1 = P = 1
+    mpz_set_ui(U, 1);
+    mpz_set_ui(V, 1);
+    mpz_set_si(Qk, Q);
+    mpz_mod(Qk, Qk, n);
+    for (long i = (long)mpz_sizeinbase(d, 2) - 2; i >= 0; i--) {
+        mpz_mul(U, U, V);                       // U_2k = U_k * V_k
+        mpz_mod(U, U, n);
+        mpz_mul(V, V, V);                       // V_2k = V_k^2 - 2 Q^k
+        mpz_submul_ui(V, Qk, 2);
+        mpz_mod(V, V, n);
+        mpz_mul(Qk, Qk, Qk);
+        mpz_mod(Qk, Qk, n);
+        if (mpz_tstbit(d, (mp_bitcnt_t)i)) {
+            mpz_mul_si(t, U, D);                // U_2k+1 = (U + V) / 2
+            mpz_add(U, U, V);                   // V_2k+1 = (D U + V) / 2
+            lucas_half(U, n);
+            mpz_add(V, V, t);
+            lucas_half(V, n);
+            mpz_mul_si(Qk, Qk, Q);
+            mpz_mod(Qk, Qk, n);
+        }
+    }
+
+    int prime = mpz_sgn(U) == 0 || mpz_sgn(V) == 0;
+    for (mp_bitcnt_t r = 1; r < s && !prime; r++) {
+        mpz_mul(V, V, V);                       // V_2k = V_k^2 - 2 Q^k
+        mpz_submul_ui(V, Qk, 2);
+        mpz_mod(V, V, n);
+        prime = mpz_sgn(V) == 0;
+        mpz_mul(Qk, Qk, Qk);
+        mpz_mod(Qk, Qk, n);
+    }
+    return prime;
+}
+
+int bpsw_ctx(const mpz_t n, PRIMALITY_CTX *c) {
+    if (mpz_cmp_ui(n, 2) < 0) return 0;
+    if (mpz_cmp_ui(n, 2) == 0) return 1;
+    if (mpz_even_p(n)) return 0;
+    if (u64_dispatch_enabled && mpz_size(n) == 1) return miller_rabin_u64(mpz_getlimbn(n, 0));
+
+    if (!trial_div_pass(n, c->t)) return 0;
+
+    if (!miller_rabin_base(n, 2, c)) return 0;
+    long D = lucas_selfridge(n, c->t);
+    return D != 0 && lucas_strong(n, D, c);
+}
+
+int bpsw(const mpz_t n) {
+    PRIMALITY_CTX c;
+    primality_ctx_init(&c);
+    int prime = bpsw_ctx(n, &c);
+    primality_ctx_clear(&c);
+    return prime;
+}
@@ -2,6 +2,7 @@
 #include <stdlib.h>
 #include <time.h>
 #include <stdbool.h>
+#include "cycle_timer.h"
 
 /* Standard swap */
 static inline void swap_int(int *a, int *b) {
@@ -39,22 +40,26 @@ double benchmark_size(int n, int iterations) {
         exit(EXIT_FAILURE);
     }
 
-    clock_t start = clock();
+    CT_STATS stats;
+    ct_stats_reset(&stats);
 
     for (int it = 0; it < iterations; ++it) {
         fill_random(buf, n);
+        uint64_t start = ct_start();
         bubbleSort(buf, n);
+        ct_stats_add(&stats, ct_elapsed(start, ct_stop()));
     }
 
-    clock_t end = clock();
     free(buf);
+    ct_csv_report("sort", "Bubble", (size_t)n, &stats, NULL);
 
-    return (double)(end - start) / CLOCKS_PER_SEC;
+    return stats.total / ct_hz();
 }
 
 int main(void) {
 
     srand((unsigned)time(NULL));  // Seed RNG once
+    ct_init();                     // Calibrate TSC before timing
 
     const int sizes[] = {100, 200, 300, 400, 500, 600, 700, 800, 900, 1000};
     const int count = sizeof(sizes) / sizeof(sizes[0]);
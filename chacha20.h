@@ -0,0 +1,18 @@
+// chacha20.h
+// ChaCha20 stream cipher (Chacha20.c, RFC 8439 layout: 256-bit key, 96-bit nonce).
+
+#ifndef CHACHA20_H
+#define CHACHA20_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/* Non-zero makes chacha20_block() print its state dumps (demo program only). */
+extern int chacha20_trace;
+
+void chacha20_block(uint32_t out[16], const uint32_t in[16]);
+void initialize_state(uint32_t st[16], const uint8_t key[32], const uint8_t nonce[12], uint32_t counter);
+void chacha20_encrypt(const uint8_t *pt, uint8_t *ct, size_t len,
+                      const uint8_t key[32], const uint8_t nonce[12], uint32_t counter);
+
+#endif /* CHACHA20_H */
@@ -0,0 +1,642 @@
+/*
+Unified benchmark driver for the crypto primitives in this repo.
+
+To compile (library sources built without their demo main()):
+    make crypto_bench        (see Makefile; links build/libcryptoimpl.a)
+
+To run:
+    ./crypto_bench --list
+    ./crypto_bench --algo aes,chacha20 --size 4096 --iters 10000 --threads 4 --pin 0,1,2,3
+    ./crypto_bench --algo all --format csv --out run.csv
+    ./crypto_bench --algo all --baseline run.csv --tolerance 5
+
+Notes:
+- --size is bytes for ciphers, prime bits for RSA, candidate bits for primality tests.
+- Every thread runs --iters timed iterations on its own state; stats are merged.
+- CSV uses the common cycle_timer.h schema (variant = "t<threads>"), so a saved
+  CSV can be fed back with --baseline; the run exits with status 3 when any
+  benchmark's avg_cycles is more than --tolerance percent above the baseline.
+*/
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include <sched.h>
+#include <gmp.h>
+
+#include "cycle_timer.h"
+#include "aes.h"
+#include "chacha20.h"
+#include "salsa20.h"
+#include "rc4.h"
+#include "primality.h"
+#include "rsa_key.h"
+#include "montgomery.h"
+#include "rsa_keystore.h"
+
+#define MAX_THREADS 256
+
+/* ---- Options ---- */
+
+typedef struct {
+    const char *algos;      // comma-separated names or "all"
+    size_t size;            // 0 = benchmark default
+    long iters;             // 0 = benchmark default
+    int threads;
+    int rounds;             // k for the primality tests
+    int pin[MAX_THREADS];
+    int pin_count;
+    int perf;
+    const char *format;     // "text", "csv" or "json"
+    const char *out;
+    const char *baseline;
+    const char *keys;       // RSA key store reused across runs (NULL = generate)
+    double tolerance;       // percent
+} BENCH_OPTS;
+
+/* ---- Registry ---- */
+
+typedef struct {
+    const char *name;
+    const char *unit;       // what --size means for this benchmark
+    size_t default_size;
+    long default_iters;
+    void *(*setup)(const BENCH_OPTS *o, size_t size, unsigned long seed);
+    void (*run)(void *state);
+    void (*teardown)(void *state);
+} BENCH;
+
+/* ---- Symmetric ciphers ---- */
+
+typedef struct {
+    size_t len;
+    uint8_t *in, *out;
+    uint8_t key[32], nonce[12];
+    uint8_t rk[AES_ROUNDKEY_LEN];
+    RC4_CTX rc4;
+} CIPHER_STATE;
+
+static void *cipher_setup(const BENCH_OPTS *o, size_t size, unsigned long seed) {
+    (void)o;
+    CIPHER_STATE *st = calloc(1, sizeof *st);
+    if (!st) return NULL;
+    st->len = (size + 15) & ~(size_t)15;      // whole AES blocks
+    st->in  = malloc(st->len);
+    st->out = malloc(st->len);
+    if (!st->in || !st->out) { free(st->in); free(st->out); free(st); return NULL; }
+    srand((unsigned)seed);
+    for (size_t i = 0; i < st->len; i++) st->in[i] = (uint8_t)rand();
+    for (int i = 0; i < 32; i++) st->key[i] = (uint8_t)rand();
+    for (int i = 0; i < 12; i++) st->nonce[i] = (uint8_t)rand();
+    KeyExpansion(st->key, st->rk);
+    rc4_init(&st->rc4, st->key, sizeof st->key);
+    return st;
+}
+
+static void cipher_teardown(void *p) {
+    CIPHER_STATE *st = p;
+    free(st->in);
+    free(st->out);
+    free(st);
+}
+
+static void aes_run(void *p) {
+    CIPHER_STATE *st = p;
+    AES_ECB_encrypt(st->in, (int)st->len, st->rk, st->out);
+}
+
+static void chacha20_run(void *p) {
+    CIPHER_STATE *st = p;
+    chacha20_encrypt(st->in, st->out, st->len, st->key, st->nonce, 1);
+}
+
+static void salsa20_run(void *p) {
+    CIPHER_STATE *st = p;
+    uint32_t blk[16];
+    for (size_t off = 0; off + 64 <= st->len; off += 64) {
+        memcpy(blk, st->in + off, 64);
+        salsa20_block((uint32_t *)(void *)(st->out + off), blk);
+    }
+}
+
+static void rc4_run(void *p) {
+    CIPHER_STATE *st = p;
+    rc4_crypt(&st->rc4, st->in, st->len);
+}
+
+/* ---- RSA ---- */
+
+typedef struct {
+    gmp_randstate_t rng;
+    RSA_KEY key;
+    RSA_BLINDING blind;
+    mpz_t m, c, m2;
+    int prime_bits;
+} RSA_STATE;
+
+/* Key of the requested size from --keys, generated and saved there when missing */
+static int rsa_load_key(const BENCH_OPTS *o, RSA_KEY *key, int prime_bits, gmp_randstate_t rng) {
+    static pthread_mutex_t store_mu = PTHREAD_MUTEX_INITIALIZER;
+    if (!o->keys) return rsa_key_generate(key, prime_bits, rng);
+
+    pthread_mutex_lock(&store_mu);
+    RSA_KEYSTORE *ks = rsa_keystore_open(o->keys);
+    int slot = ks ? rsa_keystore_find(ks, prime_bits) : -1;
+    int rc = 0;
+    if (slot >= 0) {
+        RSA_KEY view;
+        rsa_keystore_get(ks, slot, &view, NULL);
+        // private copy: the benchmarks outlive the mapping
+        mpz_set(key->n, view.n);   mpz_set(key->e, view.e);   mpz_set(key->d, view.d);
+        mpz_set(key->p, view.p);   mpz_set(key->q, view.q);
+        mpz_set(key->dP, view.dP); mpz_set(key->dQ, view.dQ); mpz_set(key->qInv, view.qInv);
+        key->prime_bits = view.prime_bits;
+        rc = rsa_key_precompute(key);
+    } else if ((rc = rsa_key_generate(key, prime_bits, rng)) == 0) {
+        rsa_keystore_append(o->keys, key);
+    }
+    rsa_keystore_close(ks);
+    pthread_mutex_unlock(&store_mu);
+    return rc;
+}
+
+static void *rsa_setup(const BENCH_OPTS *o, size_t size, unsigned long seed) {
+    RSA_STATE *st = malloc(sizeof *st);
+    if (!st) return NULL;
+    st->prime_bits = (int)size;
+    gmp_randinit_mt(st->rng);
+    gmp_randseed_ui(st->rng, seed);
+    rsa_key_init(&st->key);
+    mpz_inits(st->m, st->c, st->m2, NULL);
+    if (rsa_load_key(o, &st->key, st->prime_bits, st->rng) != 0) {
+        fprintf(stderr, "rsa: unsupported prime size %d\n", st->prime_bits);
+        mpz_clears(st->m, st->c, st->m2, NULL);
+        rsa_key_clear(&st->key);
+        gmp_randclear(st->rng);
+        free(st);
+        return NULL;
+    }
+    mpz_urandomm(st->m, st->rng, st->key.n);
+    rsa_encrypt(st->c, st->m, &st->key);
+    rsa_blinding_init(&st->blind, &st->key, st->rng);
+    return st;
+}
+
+static void rsa_teardown(void *p) {
+    RSA_STATE *st = p;
+    mpz_clears(st->m, st->c, st->m2, NULL);
+    rsa_blinding_clear(&st->blind);
+    rsa_key_clear(&st->key);
+    gmp_randclear(st->rng);
+    free(st);
+}
+
+static void rsa_keygen_run(void *p) {
+    RSA_STATE *st = p;
+    rsa_key_generate(&st->key, st->prime_bits, st->rng);
+}
+
+static void rsa_encrypt_run(void *p) {
+    RSA_STATE *st = p;
+    rsa_encrypt(st->m2, st->m, &st->key);
+}
+
+static void rsa_decrypt_run(void *p) {
+    RSA_STATE *st = p;
+    rsa_decrypt(st->m2, st->c, &st->key);
+}
+
+static void rsa_decrypt_crt_run(void *p) {
+    RSA_STATE *st = p;
+    rsa_decrypt_crt(st->m2, st->c, &st->key);
+}
+
+static void rsa_decrypt_ct_run(void *p) {
+    RSA_STATE *st = p;
+    rsa_decrypt_ct(st->m2, st->c, &st->key, &st->blind);
+}
+
+/* ---- Primality ---- */
+
+typedef struct {
+    gmp_randstate_t rng;
+    mpz_t n;
+    int k;
+} PRIME_STATE;
+
+static void *prime_setup(const BENCH_OPTS *o, size_t size, unsigned long seed) {
+    PRIME_STATE *st = malloc(sizeof *st);
+    if (!st) return NULL;
+    st->k = o->rounds;
+    gmp_randinit_default(st->rng);
+    gmp_randseed_ui(st->rng, seed);
+    mpz_init(st->n);
+    // worst case for the tests: a prime runs all k rounds
+    mpz_urandomb(st->n, st->rng, size);
+    mpz_setbit(st->n, size - 1);
+    mpz_nextprime(st->n, st->n);
+    return st;
+}
+
+static void prime_teardown(void *p) {
+    PRIME_STATE *st = p;
+    mpz_clear(st->n);
+    gmp_randclear(st->rng);
+    free(st);
+}
+
+static void miller_rabin_run(void *p) {
+    PRIME_STATE *st = p;
+    miller_rabin(st->n, st->k, st->rng);
+}
+
+static void solovay_strassen_run(void *p) {
+    PRIME_STATE *st = p;
+    solovay_strassen(st->n, st->k, st->rng);
+}
+
+static void bpsw_run(void *p) {
+    PRIME_STATE *st = p;
+    bpsw(st->n);
+}
+
+static const BENCH benches[] = {
+    {"aes",              "bytes",      4096,  20000, cipher_setup, aes_run,              cipher_teardown},
+    {"chacha20",         "bytes",      4096,  20000, cipher_setup, chacha20_run,         cipher_teardown},
+    {"salsa20",          "bytes",      4096,  20000, cipher_setup, salsa20_run,          cipher_teardown},
+    {"rc4",              "bytes",      4096,  20000, cipher_setup, rc4_run,              cipher_teardown},
+    {"rsa-keygen",       "prime bits",  512,     50, rsa_setup,    rsa_keygen_run,       rsa_teardown},
+    {"rsa-encrypt",      "prime bits",  512,  10000, rsa_setup,    rsa_encrypt_run,      rsa_teardown},
+    {"rsa-decrypt",      "prime bits",  512,   1000, rsa_setup,    rsa_decrypt_run,      rsa_teardown},
+    {"rsa-decrypt-crt",  "prime bits",  512,   1000, rsa_setup,    rsa_decrypt_crt_run,  rsa_teardown},
+    {"rsa-decrypt-ct",   "prime bits",  512,   1000, rsa_setup,    rsa_decrypt_ct_run,   rsa_teardown},
+    {"miller-rabin",     "bits",       1024,    200, prime_setup,  miller_rabin_run,     prime_teardown},
+    {"solovay-strassen", "bits",       1024,    200, prime_setup,  solovay_strassen_run, prime_teardown},
+    {"bpsw",             "bits",       1024,    200, prime_setup,  bpsw_run,             prime_teardown},
+};
+static const int bench_count = sizeof(benches) / sizeof(benches[0]);
+
+/* ---- Runner ---- */
+
+typedef struct {
+    const BENCH *b;
+    const BENCH_OPTS *o;
+    size_t size;
+    long iters;
+    int tid;
+    pthread_barrier_t *barrier;
+    pthread_mutex_t *start_mu;             // held by run_bench while it spawns
+    const int *abort;                      // set if a worker failed to start
+    CT_STATS stats;
+    CT_PERF perf;
+    int failed;
+} WORKER;
+
+typedef struct {
+    const BENCH *b;
+    size_t size;
+    int threads;
+    CT_STATS stats;
+    CT_PERF perf;
+    double wall_ns;
+} RESULT;
+
+static void pin_thread(const BENCH_OPTS *o, int tid) {
+    if (o->pin_count == 0) return;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(o->pin[tid % o->pin_count], &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof set, &set) != 0)
+        fprintf(stderr, "warning: could not pin thread %d to CPU %d\n",
+                tid, o->pin[tid % o->pin_count]);
+}
+
+static void *worker_main(void *arg) {
+    WORKER *w = arg;
+    pthread_mutex_lock(w->start_mu);
+    int abort = *w->abort;
+    pthread_mutex_unlock(w->start_mu);
+    if (abort) return NULL;
+    pin_thread(w->o, w->tid);
+
+    void *state = w->b->setup(w->o, w->size, 0x5eed0000ul + (unsigned long)w->tid);
+    if (!state) w->failed = 1;
+    else w->b->run(state);                 // warm-up: caches, GMP allocations
+
+    ct_stats_reset(&w->stats);
+    if (w->o->perf) ct_perf_open(&w->perf);
+    else for (int i = 0; i < CT_PERF_COUNT; i++) w->perf.fd[i] = -1;
+
+    pthread_barrier_wait(w->barrier);      // all threads start timing together
+    if (state) {
+        ct_perf_begin(&w->perf);
+        for (long i = 0; i < w->iters; i++) {
+            uint64_t t0 = ct_start();
+            w->b->run(state);
+            uint64_t t1 = ct_stop();
+            ct_stats_add(&w->stats, ct_elapsed(t0, t1));
+        }
+        ct_perf_end(&w->perf);
+    }
+    pthread_barrier_wait(w->barrier);
+
+    ct_perf_close(&w->perf);
+    if (state) w->b->teardown(state);
+    return NULL;
+}
+
+static int run_bench(const BENCH *b, const BENCH_OPTS *o, RESULT *res) {
+    int nt = o->threads;
+    WORKER *w = calloc((size_t)nt, sizeof *w);
+    pthread_t *tids = calloc((size_t)nt, sizeof *tids);
+    if (!w || !tids) { free(w); free(tids); return -1; }
+
+    pthread_barrier_t barrier;
+    pthread_barrier_init(&barrier, NULL, (unsigned)nt + 1);
+    pthread_mutex_t start_mu = PTHREAD_MUTEX_INITIALIZER;
+    int abort = 0;
+
+    res->b = b;
+    res->size = o->size ? o->size : b->default_size;
+    res->threads = nt;
+    long iters = o->iters ? o->iters : b->default_iters;
+
+    // workers wait on start_mu until all of them exist; if one cannot be
+    // created the others leave before touching the barrier
+    int started = 0;
+    pthread_mutex_lock(&start_mu);
+    for (int t = 0; t < nt; t++) {
+        w[t] = (WORKER){ .b = b, .o = o, .size = res->size, .iters = iters,
+                         .tid = t, .barrier = &barrier,
+                         .start_mu = &start_mu, .abort = &abort };
+        if (pthread_create(&tids[t], NULL, worker_main, &w[t]) != 0) {
+            fprintf(stderr, "%s: cannot start thread %d\n", b->name, t);
+            abort = 1;
+            break;
+        }
+        started++;
+    }
+    pthread_mutex_unlock(&start_mu);
+    if (abort) {
+        for (int t = 0; t < started; t++) pthread_join(tids[t], NULL);
+        pthread_barrier_destroy(&barrier);
+        free(w);
+        free(tids);
+        return -1;
+    }
+    pthread_barrier_wait(&barrier);
+    uint64_t wall0 = ct_start();
+    pthread_barrier_wait(&barrier);
+    uint64_t wall1 = ct_stop();
+    for (int t = 0; t < nt; t++) pthread_join(tids[t], NULL);
+    res->wall_ns = ct_to_ns((double)ct_elapsed(wall0, wall1));
+
+    int failed = 0;
+    ct_stats_reset(&res->stats);
+    for (int i = 0; i < CT_PERF_COUNT; i++) { res->perf.fd[i] = -1; res->perf.value[i] = 0; }
+    for (int t = 0; t < nt; t++) {
+        failed |= w[t].failed;
+        res->stats.n += w[t].stats.n;
+        res->stats.total += w[t].stats.total;
+        if (w[t].stats.min < res->stats.min) res->stats.min = w[t].stats.min;
+        if (w[t].stats.max > res->stats.max) res->stats.max = w[t].stats.max;
+        for (int i = 0; i < CT_PERF_COUNT; i++) {
+            if (!o->perf || w[t].perf.value[i] == 0) continue;
+            res->perf.fd[i] = 0;          // marks the column as present
+            res->perf.value[i] += w[t].perf.value[i];
+        }
+    }
+
+    pthread_barrier_destroy(&barrier);
+    free(w);
+    free(tids);
+    return failed ? -1 : 0;
+}
+
+/* ---- Output ---- */
+
+static double ops_per_sec(const RESULT *r) {
+    return r->wall_ns > 0 ? (double)r->stats.n * 1e9 / r->wall_ns : 0.0;
+}
+
+static void print_text(FILE *f, const RESULT *r) {
+    fprintf(f, "%-17s size=%-6zu %-10s threads=%-3d iters=%-8llu "
+               "min=%-10llu avg=%-12.2f max=%-10llu ops/s=%.1f\n",
+            r->b->name, r->size, r->b->unit, r->threads,
+            (unsigned long long)r->stats.n, (unsigned long long)r->stats.min,
+            ct_stats_avg(&r->stats), (unsigned long long)r->stats.max, ops_per_sec(r));
+}
+
+static void print_json(FILE *f, const RESULT *r, int first) {
+    double avg = ct_stats_avg(&r->stats);
+    fprintf(f, "%s  {\"benchmark\": \"%s\", \"size\": %zu, \"unit\": \"%s\", \"threads\": %d, "
+               "\"iterations\": %llu, \"min_cycles\": %llu, \"avg_cycles\": %.2f, "
+               "\"max_cycles\": %llu, \"avg_ns\": %.2f, \"ops_per_sec\": %.2f, \"tsc_hz\": %.0f",
+            first ? "" : ",\n", r->b->name, r->size, r->b->unit, r->threads,
+            (unsigned long long)r->stats.n, (unsigned long long)r->stats.min, avg,
+            (unsigned long long)r->stats.max, ct_to_ns(avg), ops_per_sec(r), ct_hz());
+    static const char *perf_names[CT_PERF_COUNT] = {
+        "perf_cycles", "perf_instructions", "perf_cache_misses"
+    };
+    for (int i = 0; i < CT_PERF_COUNT; i++)
+        if (r->perf.fd[i] >= 0)
+            fprintf(f, ", \"%s\": %llu", perf_names[i], (unsigned long long)r->perf.value[i]);
+    fputc('}', f);
+}
+
+static void write_results(FILE *f, const BENCH_OPTS *o, const RESULT *res, int n) {
+    char variant[16];
+    if (strcmp(o->format, "csv") == 0) {
+        ct_csv_header(f);
+        for (int i = 0; i < n; i++) {
+            snprintf(variant, sizeof variant, "t%d", res[i].threads);
+            ct_csv_row(f, res[i].b->name, variant, res[i].size, &res[i].stats, &res[i].perf);
+        }
+    } else if (strcmp(o->format, "json") == 0) {
+        fprintf(f, "[\n");
+        for (int i = 0; i < n; i++) print_json(f, &res[i], i == 0);
+        fprintf(f, "\n]\n");
+    } else {
+        for (int i = 0; i < n; i++) print_text(f, &res[i]);
+    }
+}
+
+/* ---- Baseline comparison ---- */
+
+/* Looks up avg_cycles for (bench, variant, size) in a CSV written by --format csv */
+static int baseline_lookup(FILE *f, const char *bench, const char *variant, size_t size,
+                           double *avg) {
+    char line[512];
+    rewind(f);
+    while (fgets(line, sizeof line, f)) {
+        char name[64], var[32];
+        size_t sz;
+        unsigned long long iters, mn;
+        double a;
+        if (sscanf(line, "%63[^,],%31[^,],%zu,%llu,%llu,%lf", name, var, &sz, &iters, &mn, &a) != 6)
+            continue;   // header or malformed line
+        if (strcmp(name, bench) == 0 && strcmp(var, variant) == 0 && sz == size) {
+            *avg = a;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int compare_baseline(const BENCH_OPTS *o, const RESULT *res, int n) {
+    FILE *f = fopen(o->baseline, "r");
+    if (!f) {
+        perror(o->baseline);
+        return -1;
+    }
+    int regressions = 0;
+    char variant[16];
+    fprintf(stderr, "\nBaseline comparison against %s (tolerance %.1f%%):\n", o->baseline, o->tolerance);
+    for (int i = 0; i < n; i++) {
+        double base;
+        snprintf(variant, sizeof variant, "t%d", res[i].threads);
+        if (baseline_lookup(f, res[i].b->name, variant, res[i].size, &base) != 0 || base <= 0) {
+            fprintf(stderr, "  %-17s %-4s %-6zu  no baseline\n", res[i].b->name, variant, res[i].size);
+            continue;
+        }
+        double now = ct_stats_avg(&res[i].stats);
+        double delta = (now - base) * 100.0 / base;
+        int bad = delta > o->tolerance;
+        regressions += bad;
+        fprintf(stderr, "  %-17s %-4s %-6zu  %12.2f -> %12.2f cycles  %+7.2f%%  %s\n",
+                res[i].b->name, variant, res[i].size, base, now, delta, bad ? "REGRESSION" : "ok");
+    }
+    fclose(f);
+    return regressions;
+}
+
+/* ---- Main ---- */
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  --algo LIST       comma-separated benchmarks or 'all' (default: all)\n"
+        "  --size N          bytes (ciphers) / bits (RSA primes, primality candidates)\n"
+        "  --iters N         timed iterations per thread\n"
+        "  --threads N       worker threads (default 1)\n"
+        "  --pin LIST        pin thread i to CPU LIST[i %% len], e.g. 0,2,4,6\n"
+        "  --rounds K        primality test rounds (default 25)\n"
+        "  --powm B          modular exponentiation backend: gmp | mont\n"
+        "  --perf            also read perf_event cycles/instructions/cache misses\n"
+        "  --format F        text | csv | json (default text)\n"
+        "  --out FILE        write results to FILE instead of stdout\n"
+        "  --baseline FILE   compare avg cycles against a CSV from an earlier run\n"
+        "  --keys FILE       reuse RSA keys from a key store, saving new ones there\n"
+        "  --tolerance PCT   allowed slowdown vs baseline (default 10)\n"
+        "  --list            list registered benchmarks\n", prog);
+}
+
+static int parse_pin(BENCH_OPTS *o, const char *list) {
+    char *copy = strdup(list);
+    if (!copy) return -1;
+    o->pin_count = 0;
+    for (char *tok = strtok(copy, ","); tok && o->pin_count < MAX_THREADS; tok = strtok(NULL, ","))
+        o->pin[o->pin_count++] = atoi(tok);
+    free(copy);
+    return o->pin_count > 0 ? 0 : -1;
+}
+
+static int selected(const char *algos, const char *name) {
+    if (strcmp(algos, "all") == 0) return 1;
+    size_t len = strlen(name);
+    for (const char *p = algos; (p = strstr(p, name)) != NULL; p += len) {
+        int starts = (p == algos || p[-1] == ',');
+        int ends = (p[len] == '\0' || p[len] == ',');
+        if (starts && ends) return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    BENCH_OPTS o = { .algos = "all", .threads = 1, .rounds = 25,
+                     .format = "text", .tolerance = 10.0 };
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(a, "--list") == 0) {
+            for (int b = 0; b < bench_count; b++)
+                printf("%-17s size in %-10s default size %-6zu iters %ld\n", benches[b].name,
+                       benches[b].unit, benches[b].default_size, benches[b].default_iters);
+            return 0;
+        } else if (strcmp(a, "--perf") == 0) {
+            o.perf = 1;
+            continue;
+        } else if (strcmp(a, "-h") == 0 || strcmp(a, "--help") == 0) {
+            usage(argv[0]);
+            return 0;
+        }
+        if (!v) { usage(argv[0]); return 1; }
+        if      (strcmp(a, "--algo") == 0)      o.algos = v;
+        else if (strcmp(a, "--size") == 0)      o.size = strtoul(v, NULL, 0);
+        else if (strcmp(a, "--iters") == 0)     o.iters = strtol(v, NULL, 0);
+        else if (strcmp(a, "--threads") == 0)   o.threads = atoi(v);
+        else if (strcmp(a, "--rounds") == 0)    o.rounds = atoi(v);
+        else if (strcmp(a, "--powm") == 0) {
+            if (strcmp(v, "gmp") == 0)       powm_backend = POWM_GMP;
+            else if (strcmp(v, "mont") == 0) powm_backend = POWM_MONT;
+            else { fprintf(stderr, "bad --powm backend: %s\n", v); return 1; }
+        }
+        else if (strcmp(a, "--format") == 0)    o.format = v;
+        else if (strcmp(a, "--out") == 0)       o.out = v;
+        else if (strcmp(a, "--baseline") == 0)  o.baseline = v;
+        else if (strcmp(a, "--keys") == 0)      o.keys = v;
+        else if (strcmp(a, "--tolerance") == 0) o.tolerance = atof(v);
+        else if (strcmp(a, "--pin") == 0) {
+            if (parse_pin(&o, v) != 0) { fprintf(stderr, "bad --pin list: %s\n", v); return 1; }
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+    }
+    if (o.threads < 1 || o.threads > MAX_THREADS) {
+        fprintf(stderr, "--threads must be between 1 and %d\n", MAX_THREADS);
+        return 1;
+    }
+
+    ct_init();
+    RESULT *res = calloc((size_t)bench_count, sizeof *res);
+    if (!res) return 1;
+    int n = 0;
+    for (int b = 0; b < bench_count; b++) {
+        if (!selected(o.algos, benches[b].name)) continue;
+        fprintf(stderr, "running %s...\n", benches[b].name);
+        if (run_bench(&benches[b], &o, &res[n]) != 0) {
+            fprintf(stderr, "%s: setup failed\n", benches[b].name);
+            continue;
+        }
+        n++;
+    }
+    if (n == 0) {
+        fprintf(stderr, "no benchmark matched '%s' (see --list)\n", o.algos);
+        free(res);
+        return 1;
+    }
+
+    FILE *out = stdout;
+    if (o.out && !(out = fopen(o.out, "w"))) {
+        perror(o.out);
+        free(res);
+        return 1;
+    }
+    write_results(out, &o, res, n);
+    if (out != stdout) fclose(out);
+
+    int status = 0;
+    if (o.baseline) {
+        int reg = compare_baseline(&o, res, n);
+        if (reg < 0) status = 1;
+        else if (reg > 0) status = 3;
+    }
+    free(res);
+    return status;
+}
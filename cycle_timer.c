@@ -0,0 +1,194 @@
+// cycle_timer.c
+// Implementation of the shared benchmark timer (see cycle_timer.h).
+
+#define _GNU_SOURCE
+#include "cycle_timer.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <unistd.h>
+
+#ifdef __linux__
+  #include <sys/ioctl.h>
+  #include <sys/syscall.h>
+  #include <linux/perf_event.h>
+#endif
+
+#define CT_CALIBRATE_NS   50000000ull   // 50 ms calibration window
+#define CT_OVERHEAD_RUNS  10000
+
+static double   g_hz = 1e9;
+static uint64_t g_overhead = 0;
+static pthread_once_t g_once = PTHREAD_ONCE_INIT;
+
+static uint64_t mono_raw_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static void ct_calibrate(void) {
+#if CT_HAVE_TSC
+    // Busy-wait a fixed wall-clock window and count TSC ticks across it.
+    uint64_t ns0 = mono_raw_ns();
+    uint64_t t0  = ct_start();
+    uint64_t ns1;
+    do { ns1 = mono_raw_ns(); } while (ns1 - ns0 < CT_CALIBRATE_NS);
+    uint64_t t1 = ct_stop();
+    g_hz = (double)(t1 - t0) * 1e9 / (double)(ns1 - ns0);
+#endif
+
+    // Fence overhead: cheapest empty start/stop pair.
+    uint64_t best = ~0ull;
+    for (int i = 0; i < CT_OVERHEAD_RUNS; i++) {
+        uint64_t a = ct_start();
+        uint64_t b = ct_stop();
+        if (b - a < best) best = b - a;
+    }
+    g_overhead = best;
+}
+
+void ct_init(void) {
+    pthread_once(&g_once, ct_calibrate);
+}
+
+double ct_hz(void) {
+    ct_init();
+    return g_hz;
+}
+
+uint64_t ct_overhead(void) {
+    ct_init();
+    return g_overhead;
+}
+
+uint64_t ct_elapsed(uint64_t start, uint64_t stop) {
+    ct_init();
+    uint64_t d = stop - start;
+    return d > g_overhead ? d - g_overhead : 0;
+}
+
+double ct_to_ns(double ticks) {
+    return ticks * 1e9 / ct_hz();
+}
+
+/* ---------- Statistics ---------- */
+
+void ct_stats_reset(CT_STATS *s) {
+    s->n = 0;
+    s->min = ~0ull;
+    s->max = 0;
+    s->total = 0.0;
+}
+
+void ct_stats_add(CT_STATS *s, uint64_t ticks) {
+    s->n++;
+    if (ticks < s->min) s->min = ticks;
+    if (ticks > s->max) s->max = ticks;
+    s->total += (double)ticks;
+}
+
+double ct_stats_avg(const CT_STATS *s) {
+    return s->n ? s->total / (double)s->n : 0.0;
+}
+
+/* ---------- perf_event counters ---------- */
+
+#ifdef __linux__
+static int perf_open_one(uint32_t type, uint64_t config) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof attr);
+    attr.size = sizeof attr;
+    attr.type = type;
+    attr.config = config;
+    attr.disabled = 1;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+}
+#endif
+
+int ct_perf_open(CT_PERF *p) {
+    int opened = 0;
+    for (int i = 0; i < CT_PERF_COUNT; i++) { p->fd[i] = -1; p->value[i] = 0; }
+#ifdef __linux__
+    static const uint64_t cfg[CT_PERF_COUNT] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_MISSES
+    };
+    for (int i = 0; i < CT_PERF_COUNT; i++) {
+        p->fd[i] = perf_open_one(PERF_TYPE_HARDWARE, cfg[i]);
+        if (p->fd[i] >= 0) opened++;
+    }
+#endif
+    return opened;
+}
+
+void ct_perf_begin(CT_PERF *p) {
+#ifdef __linux__
+    for (int i = 0; i < CT_PERF_COUNT; i++) {
+        if (p->fd[i] < 0) continue;
+        ioctl(p->fd[i], PERF_EVENT_IOC_RESET, 0);
+        ioctl(p->fd[i], PERF_EVENT_IOC_ENABLE, 0);
+    }
+#else
+    (void)p;
+#endif
+}
+
+void ct_perf_end(CT_PERF *p) {
+#ifdef __linux__
+    for (int i = 0; i < CT_PERF_COUNT; i++) {
+        if (p->fd[i] < 0) continue;
+        ioctl(p->fd[i], PERF_EVENT_IOC_DISABLE, 0);
+        uint64_t v = 0;
+        if (read(p->fd[i], &v, sizeof v) == (ssize_t)sizeof v) p->value[i] = v;
+    }
+#else
+    (void)p;
+#endif
+}
+
+void ct_perf_close(CT_PERF *p) {
+    for (int i = 0; i < CT_PERF_COUNT; i++) {
+        if (p->fd[i] >= 0) close(p->fd[i]);
+        p->fd[i] = -1;
+    }
+}
+
+/* ---------- CSV ---------- */
+
+void ct_csv_header(FILE *f) {
+    fprintf(f, "benchmark,variant,size,iterations,min_cycles,avg_cycles,max_cycles,"
+               "avg_ns,tsc_hz,perf_cycles,perf_instructions,perf_cache_misses\n");
+}
+
+void ct_csv_row(FILE *f, const char *bench, const char *variant, size_t size,
+                const CT_STATS *s, const CT_PERF *perf) {
+    double avg = ct_stats_avg(s);
+    fprintf(f, "%s,%s,%zu,%llu,%llu,%.2f,%llu,%.2f,%.0f",
+            bench, variant ? variant : "", size,
+            (unsigned long long)s->n,
+            (unsigned long long)(s->n ? s->min : 0), avg,
+            (unsigned long long)s->max, ct_to_ns(avg), ct_hz());
+    for (int i = 0; i < CT_PERF_COUNT; i++) {
+        if (perf && perf->fd[i] >= 0) fprintf(f, ",%llu", (unsigned long long)perf->value[i]);
+        else fputc(',', f);
+    }
+    fputc('\n', f);
+}
+
+void ct_csv_report(const char *bench, const char *variant, size_t size,
+                   const CT_STATS *s, const CT_PERF *perf) {
+    const char *path = getenv("CT_CSV");
+    if (!path || !*path) return;
+    FILE *f = fopen(path, "a");
+    if (!f) return;
+    fseek(f, 0, SEEK_END);
+    if (ftell(f) == 0) ct_csv_header(f);
+    ct_csv_row(f, bench, variant, size, s, perf);
+    fclose(f);
+}
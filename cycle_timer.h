@@ -0,0 +1,109 @@
+// cycle_timer.h
+// Shared high-resolution timing for every benchmark in this repo.
+//
+//   ct_init()            calibrate TSC against CLOCK_MONOTONIC_RAW and measure
+//                        the cost of an empty ct_start()/ct_stop() pair
+//   ct_start()/ct_stop() fenced TSC reads (lfence;rdtsc ... rdtscp;lfence)
+//   ct_elapsed()         stop - start minus the fence overhead, clamped at 0
+//   CT_STATS             min/avg/max accumulator
+//   CT_PERF              optional perf_event counters (cycles, instructions,
+//                        cache misses); silently disabled when unavailable
+//   ct_csv_*             one CSV schema shared by all benchmarks
+//
+// On non-x86 targets the "cycle" counter falls back to CLOCK_MONOTONIC_RAW
+// nanoseconds, so ct_hz() reports 1e9 and the numbers stay self-consistent.
+//
+// Built into the crypto library (make lib), so every program from the Makefile
+// links it.
+
+#ifndef CYCLE_TIMER_H
+#define CYCLE_TIMER_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stddef.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+  #include <x86intrin.h>
+  #define CT_HAVE_TSC 1
+#else
+  #include <time.h>
+  #define CT_HAVE_TSC 0
+#endif
+
+/* Serialized counter read before the timed region. */
+static inline uint64_t ct_start(void) {
+#if CT_HAVE_TSC
+    _mm_lfence();
+    uint64_t t = __rdtsc();
+    _mm_lfence();
+    return t;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+/* Serialized counter read after the timed region (RDTSCP waits for prior work). */
+static inline uint64_t ct_stop(void) {
+#if CT_HAVE_TSC
+    unsigned int aux;
+    uint64_t t = __rdtscp(&aux);
+    _mm_lfence();
+    return t;
+#else
+    return ct_start();
+#endif
+}
+
+void     ct_init(void);                 // idempotent; called lazily by the helpers below
+double   ct_hz(void);                   // counter ticks per second
+uint64_t ct_overhead(void);             // ticks of an empty start/stop pair
+uint64_t ct_elapsed(uint64_t start, uint64_t stop);
+double   ct_to_ns(double ticks);
+
+/* ---------- Statistics ---------- */
+
+typedef struct {
+    uint64_t n;
+    uint64_t min, max;
+    double   total;
+} CT_STATS;
+
+void ct_stats_reset(CT_STATS *s);
+void ct_stats_add(CT_STATS *s, uint64_t ticks);
+double ct_stats_avg(const CT_STATS *s);
+
+/* ---------- perf_event counters (Linux only, optional) ---------- */
+
+enum { CT_PERF_CYCLES, CT_PERF_INSTRUCTIONS, CT_PERF_CACHE_MISSES, CT_PERF_COUNT };
+
+typedef struct {
+    int fd[CT_PERF_COUNT];      // -1 when the counter could not be opened
+    uint64_t value[CT_PERF_COUNT];
+} CT_PERF;
+
+int  ct_perf_open(CT_PERF *p);  // returns number of counters opened (0 = none)
+void ct_perf_begin(CT_PERF *p);
+void ct_perf_end(CT_PERF *p);   // fills p->value[] with counts since ct_perf_begin
+void ct_perf_close(CT_PERF *p);
+
+/* ---------- Common CSV schema ----------
+ *
+ * benchmark,variant,size,iterations,min_cycles,avg_cycles,max_cycles,
+ * avg_ns,tsc_hz,perf_cycles,perf_instructions,perf_cache_misses
+ *
+ * `size` is bytes for ciphers, bits for big-number code, elements for sorts.
+ * perf_* columns are totals over all iterations, empty when unavailable.
+ */
+void ct_csv_header(FILE *f);
+void ct_csv_row(FILE *f, const char *bench, const char *variant, size_t size,
+                const CT_STATS *s, const CT_PERF *perf);
+
+/* Append one row to the file named by $CT_CSV (header written if the file is
+ * new). No-op when CT_CSV is unset, so standalone programs stay quiet. */
+void ct_csv_report(const char *bench, const char *variant, size_t size,
+                   const CT_STATS *s, const CT_PERF *perf);
+
+#endif /* CYCLE_TIMER_H */
@@ -0,0 +1,226 @@
+/*
+Counting / bump-arena GMP allocator (see gmp_arena.h) plus a measurement of
+the allocations made by the primality tests.
+
+To compile:
+    make gmp_arena
+
+To run:
+    ./build/bin/gmp_arena [calls=2000]
+
+For 512/1024/2048-bit candidates (one prime in four, the rest composites
+that survive trial division), prints GMP allocator calls (and how many reached malloc) and cycles per test
+for miller_rabin() and solovay_strassen() as they were (mpz_inits per call),
+with a reused PRIMALITY_CTX pre-sized by primality_ctx_init2, and inside a
+bump arena.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <stdatomic.h>
+#include <gmp.h>
+
+#include "gmp_arena.h"
+#include "primality.h"
+#include "trial_div.h"
+#include "cycle_timer.h"
+
+#define GA_ALIGN 16
+
+static atomic_ullong ga_allocs, ga_reallocs, ga_frees, ga_heap;
+static _Thread_local GMP_ARENA *ga_current;
+
+static int ga_owns(const GMP_ARENA *a, const void *p) {
+    return a && (const char *)p >= a->base && (const char *)p < a->base + a->size;
+}
+
+/* Bump allocation from the current arena; NULL when it does not fit */
+static void *ga_bump(GMP_ARENA *a, size_t n) {
+    size_t off = (a->used + GA_ALIGN - 1) & ~(size_t)(GA_ALIGN - 1);
+    if (off > a->size || n > a->size - off) {
+        a->spills++;
+        return NULL;
+    }
+    a->last = off;
+    a->used = off + n;
+    return a->base + off;
+}
+
+static void *ga_alloc(size_t n) {
+    atomic_fetch_add_explicit(&ga_allocs, 1, memory_order_relaxed);
+    void *p = ga_current ? ga_bump(ga_current, n) : NULL;
+    if (p) return p;
+    atomic_fetch_add_explicit(&ga_heap, 1, memory_order_relaxed);
+    return malloc(n);
+}
+
+static void *ga_realloc(void *p, size_t old, size_t n) {
+    atomic_fetch_add_explicit(&ga_reallocs, 1, memory_order_relaxed);
+    GMP_ARENA *a = ga_current;
+    if (!ga_owns(a, p)) {
+        atomic_fetch_add_explicit(&ga_heap, 1, memory_order_relaxed);
+        return realloc(p, n);
+    }
+
+    size_t off = (size_t)((char *)p - a->base);
+    if (off == a->last && n <= a->size - off) {     // newest block: grow in place
+        a->used = off + n;
+        return p;
+    }
+    if (n <= old) return p;
+    void *q = ga_bump(a, n);
+    if (!q) {
+        atomic_fetch_add_explicit(&ga_heap, 1, memory_order_relaxed);
+        q = malloc(n);
+    }
+    memcpy(q, p, old);
+    return q;
+}
+
+static void ga_free(void *p, size_t n) {
+    (void)n;
+    atomic_fetch_add_explicit(&ga_frees, 1, memory_order_relaxed);
+    GMP_ARENA *a = ga_current;
+    if (!ga_owns(a, p)) {
+        atomic_fetch_add_explicit(&ga_heap, 1, memory_order_relaxed);
+        free(p);
+        return;
+    }
+    if ((size_t)((char *)p - a->base) == a->last) a->used = a->last;   // roll back the newest
+}
+
+void gmp_alloc_install(void) {
+    mp_set_memory_functions(ga_alloc, ga_realloc, ga_free);
+}
+
+void gmp_alloc_stats(GMP_ALLOC_STATS *s) {
+    s->allocs = atomic_load(&ga_allocs);
+    s->reallocs = atomic_load(&ga_reallocs);
+    s->frees = atomic_load(&ga_frees);
+    s->heap = atomic_load(&ga_heap);
+}
+
+void gmp_alloc_stats_reset(void) {
+    atomic_store(&ga_allocs, 0);
+    atomic_store(&ga_reallocs, 0);
+    atomic_store(&ga_frees, 0);
+    atomic_store(&ga_heap, 0);
+}
+
+int gmp_arena_init(GMP_ARENA *a, size_t bytes) {
+    memset(a, 0, sizeof *a);
+    a->base = malloc(bytes);
+    if (!a->base) return -1;
+    a->size = bytes;
+    return 0;
+}
+
+void gmp_arena_clear(GMP_ARENA *a) {
+    free(a->base);
+    a->base = NULL;
+    a->size = 0;
+}
+
+void gmp_arena_begin(GMP_ARENA *a) {
+    a->used = 0;
+    a->last = 0;
+    ga_current = a;
+}
+
+void gmp_arena_end(void) {
+    if (ga_current) ga_current->used = 0;
+    ga_current = NULL;
+}
+
+/* ---- Measurement ---- */
+
+#ifndef CRYPTO_NO_MAIN
+#define GA_CANDIDATES 16
+
+enum { MODE_PLAIN, MODE_CTX, MODE_ARENA, MODES };
+static const char *mode_name[MODES] = {"mpz_inits/call", "ctx (init2)", "bump arena"};
+
+int main(int argc, char **argv) {
+    long calls = argc > 1 ? atol(argv[1]) : 2000;
+    if (calls < 1) {
+        fprintf(stderr, "Usage: %s [calls]\n", argv[0]);
+        return 1;
+    }
+
+    static const int sizes[] = {512, 1024, 2048};
+    ct_init();
+    trial_div_init();
+    gmp_alloc_install();
+    gmp_randstate_t rng;
+    gmp_randinit_mt(rng);
+    gmp_randseed_ui(rng, 0xA11Cul);
+    GMP_ARENA arena;
+    if (gmp_arena_init(&arena, 1 << 20) != 0) return 1;
+    int failed = 0;
+
+    printf("%-17s %6s %-15s %12s %12s %12s %12s %14s\n", "test", "bits", "mode",
+           "allocs/call", "reallocs", "frees", "heap calls", "cycles/call");
+    for (size_t s = 0; s < sizeof sizes / sizeof sizes[0]; s++) {
+        int bits = sizes[s];
+        long reps = calls * 512 / bits;
+        mpz_t cand[GA_CANDIDATES];
+        for (int i = 0; i < GA_CANDIDATES; i++) {
+            mpz_init(cand[i]);
+            do {
+                mpz_urandomb(cand[i], rng, bits);
+                mpz_setbit(cand[i], bits - 1);
+                mpz_setbit(cand[i], 0);
+                if (i % 4 == 0) mpz_nextprime(cand[i], cand[i]);
+            } while (!trial_div_pass(cand[i], NULL));
+        }
+
+        for (int t = 0; t < 2; t++) {
+            int verdict[MODES][GA_CANDIDATES] = {{0}};   // fewer reps leave a tail unset
+            for (int mode = 0; mode < MODES; mode++) {
+                PRIMALITY_CTX ctx;
+                if (mode == MODE_CTX) primality_ctx_init2(&ctx, (mp_bitcnt_t)bits);
+                CT_STATS st;
+                ct_stats_reset(&st);
+                gmp_alloc_stats_reset();
+                for (long i = 0; i < reps; i++) {
+                    mpz_srcptr n = cand[i % GA_CANDIDATES];
+                    int v;
+                    uint64_t t0 = ct_start();
+                    if (mode == MODE_CTX) {
+                        v = t ? solovay_strassen_ctx(n, 8, rng, &ctx) : miller_rabin_ctx(n, 8, rng, &ctx);
+                    } else {
+                        if (mode == MODE_ARENA) gmp_arena_begin(&arena);
+                        v = t ? solovay_strassen(n, 8, rng) : miller_rabin(n, 8, rng);
+                        if (mode == MODE_ARENA) gmp_arena_end();
+                    }
+                    ct_stats_add(&st, ct_elapsed(t0, ct_stop()));
+                    verdict[mode][i % GA_CANDIDATES] = v;
+                }
+                GMP_ALLOC_STATS as;
+                gmp_alloc_stats(&as);
+                if (mode == MODE_CTX) primality_ctx_clear(&ctx);
+
+                const char *name = t ? "solovay_strassen" : "miller_rabin";
+                printf("%-17s %6d %-15s %12.2f %12.2f %12.2f %12.2f %14.0f\n", name, bits,
+                       mode_name[mode], (double)as.allocs / reps, (double)as.reallocs / reps,
+                       (double)as.frees / reps, (double)as.heap / reps, ct_stats_avg(&st));
+                char label[64];
+                snprintf(label, sizeof label, "%s_%s", name,
+                         mode == MODE_PLAIN ? "plain" : mode == MODE_CTX ? "ctx" : "arena");
+                ct_csv_report("gmp_arena", label, (size_t)bits, &st, NULL);
+            }
+            failed |= memcmp(verdict[0], verdict[1], sizeof verdict[0]) != 0
+                   || memcmp(verdict[0], verdict[2], sizeof verdict[0]) != 0;
+        }
+        for (int i = 0; i < GA_CANDIDATES; i++) mpz_clear(cand[i]);
+    }
+
+    printf("Arena spills to malloc: %llu\n", arena.spills);
+    printf("Result: %s\n", failed ? "MISMATCH" : "verdicts identical in every mode");
+    gmp_arena_clear(&arena);
+    gmp_randclear(rng);
+    return failed;
+}
+#endif /* CRYPTO_NO_MAIN */
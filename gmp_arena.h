@@ -0,0 +1,39 @@
+// gmp_arena.h
+// Counting GMP allocator with optional per-thread bump arenas.
+//
+// gmp_alloc_install() routes GMP's allocations through mp_set_memory_functions
+// to functions that count every alloc/realloc/free and otherwise use malloc,
+// so it can be installed at any time. Between gmp_arena_begin() and
+// gmp_arena_end() the calling thread's allocations are carved from a bump
+// arena instead: frees are no-ops (the newest block is rolled back) and the
+// whole arena is reset at gmp_arena_end(). Every integer allocated inside
+// the scope must be cleared before it ends; other threads are unaffected.
+
+#ifndef GMP_ARENA_H
+#define GMP_ARENA_H
+
+#include <stddef.h>
+
+typedef struct {
+    char *base;
+    size_t size, used;
+    size_t last;                // offset of the newest block (grown/rolled back in place)
+    unsigned long long spills;  // allocations that did not fit and went to malloc
+} GMP_ARENA;
+
+typedef struct {
+    unsigned long long allocs, reallocs, frees;    // calls made by GMP
+    unsigned long long heap;                       // of those, served by malloc/realloc/free
+} GMP_ALLOC_STATS;
+
+void gmp_alloc_install(void);
+void gmp_alloc_stats(GMP_ALLOC_STATS *s);   // totals over all threads since install/reset
+void gmp_alloc_stats_reset(void);
+
+// Returns 0, or -1 if the buffer could not be allocated
+int gmp_arena_init(GMP_ARENA *a, size_t bytes);
+void gmp_arena_clear(GMP_ARENA *a);
+void gmp_arena_begin(GMP_ARENA *a);         // needs gmp_alloc_install()
+void gmp_arena_end(void);
+
+#endif /* GMP_ARENA_H */
@@ -1,75 +1,688 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
 #include <gmp.h>
+#include "primality.h"
+#include "prime_search.h"
+#include "montgomery.h"
+#include "trial_div.h"
 #include <time.h>
-#include <x86intrin.h>   // For __rdtsc()
+#include "cycle_timer.h"  // Shared calibrated cycle counter
 
-// Always-inline modular exponentiation
+// Always-inline modular exponentiation (GMP or fixed-width Montgomery, montgomery.h);
+// ctx is built once per n and shared by all k rounds
 static inline __attribute__((always_inline))
-void mod_exp(mpz_t result, const mpz_t base, const mpz_t exp, const mpz_t mod) {
-    mpz_powm(result, base, exp, mod);
+void mod_exp(mpz_t result, const mpz_t base, const mpz_t exp, const mpz_t mod,
+             const MONT_CTX *ctx) {
+    crypto_powm_ctx(result, base, exp, mod, ctx);
+}
+
+/* One round with base a: 1 if n passes, 0 if a is a witness. The squaring
+   loop polls `cancel` (may be NULL) and gives up early once it is set; the
+   result is then meaningless. */
+static int mr_round(mpz_t x, const mpz_t a, const mpz_t d, unsigned long r,
+                    const mpz_t n, const mpz_t n_minus1, const MONT_CTX *ctx,
+                    const atomic_int *cancel) {
+    // Compute x = a^d mod n
+    mod_exp(x, a, d, n, ctx);
+
+    if (mpz_cmp_ui(x, 1) == 0 || mpz_cmp(x, n_minus1) == 0)
+        return 1;
+
+    for (unsigned long j = 1; j < r; j++) {
+        if (cancel && atomic_load_explicit(cancel, memory_order_relaxed)) return 1;
+        mpz_powm_ui(x, x, 2, n); // x = x^2 mod n
+
+        if (mpz_cmp(x, n_minus1) == 0)
+            return 1;
+    }
+    return 0; // a is a witness
+}
+
+/* Random base a ∈ [2, n-2]; only reached for n > 2^64 */
+static void mr_base(mpz_t a, const mpz_t n_minus1, gmp_randstate_t rng) {
+    mpz_sub_ui(a, n_minus1, 2);                 // n - 3 choices
+    mpz_urandomm(a, rng, a);
+    mpz_add_ui(a, a, 2);
+}
+
+/* n - 1 = d * 2^r with d odd */
+static unsigned long mr_split(mpz_t d, const mpz_t n_minus1) {
+    unsigned long r = mpz_scan1(n_minus1, 0);
+    mpz_fdiv_q_2exp(d, n_minus1, r);
+    return r;
+}
+
+/* ---- Native 64-bit path ---- */
+
+#define MR64_LANES 4            // bases run interleaved: independent multiply chains
+
+// Odd primes up to 37 with p^-1 mod 2^64 and (2^64 - 1) / p: p | n iff n * inv <= lim
+static const struct { uint64_t p, inv, lim; } mr64_div[] = {
+    { 3, 0xaaaaaaaaaaaaaaabull, 0x5555555555555555ull},
+    { 5, 0xcccccccccccccccdull, 0x3333333333333333ull},
+    { 7, 0x6db6db6db6db6db7ull, 0x2492492492492492ull},
+    {11, 0x2e8ba2e8ba2e8ba3ull, 0x1745d1745d1745d1ull},
+    {13, 0x4ec4ec4ec4ec4ec5ull, 0x13b13b13b13b13b1ull},
+    {17, 0xf0f0f0f0f0f0f0f1ull, 0x0f0f0f0f0f0f0f0full},
+    {19, 0x86bca1af286bca1bull, 0x0d79435e50d79435ull},
+    {23, 0xd37a6f4de9bd37a7ull, 0x0b21642c8590b216ull},
+    {29, 0x34f72c234f72c235ull, 0x08d3dcb08d3dcb08ull},
+    {31, 0xef7bdef7bdef7bdfull, 0x0842108421084210ull},
+    {37, 0x14c1bacf914c1badull, 0x06eb3e45306eb3e4ull},
+};
+
+// Deterministic bases; the first g groups of MR64_LANES are exact below mr64_bound[g - 1]
+static const uint64_t mr64_base[] = {2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37};
+static const uint64_t mr64_bound[] = {3215031751ull, 341550071728321ull, UINT64_MAX};
+
+/* Montgomery product a * b / 2^64 mod n, with ninv = n^-1 mod 2^64. The low
+   halves of a*b and m*n cancel, so only the high halves are subtracted. */
+static inline uint64_t mr64_mul(uint64_t a, uint64_t b, uint64_t n, uint64_t ninv) {
+    unsigned __int128 t = (unsigned __int128)a * b;
+    uint64_t m = (uint64_t)t * ninv;
+    uint64_t th = (uint64_t)(t >> 64);
+    uint64_t mh = (uint64_t)(((unsigned __int128)m * n) >> 64);
+    return th >= mh ? th - mh : th - mh + n;
+}
+
+typedef struct {
+    uint64_t n, ninv, d;
+    int s;                      // n - 1 = d * 2^s
+    uint64_t one, minus_one;    // R and -R mod n (Montgomery 1 and -1)
+    uint64_t r2;                // R^2 mod n
+} MR64;
+
+/* Strong test to MR64_LANES bases at once; 0 if any of them is a witness */
+static int mr64_group(const MR64 *m, const uint64_t *base) {
+    uint64_t b[MR64_LANES], x[MR64_LANES];
+    for (int l = 0; l < MR64_LANES; l++) x[l] = b[l] = mr64_mul(base[l], m->r2, m->n, m->ninv);
+
+    // x = base^d, left to right over d; the lanes only share the bit pattern
+    for (int j = 62 - __builtin_clzll(m->d); j >= 0; j--) {
+        for (int l = 0; l < MR64_LANES; l++) x[l] = mr64_mul(x[l], x[l], m->n, m->ninv);
+        if (m->d >> j & 1)
+            for (int l = 0; l < MR64_LANES; l++) x[l] = mr64_mul(x[l], b[l], m->n, m->ninv);
+    }
+
+    for (int l = 0; l < MR64_LANES; l++) {
+        uint64_t y = x[l];
+        if (y == m->one || y == m->minus_one) continue;
+        int r = 1;
+        for (; r < m->s; r++) {
+            y = mr64_mul(y, y, m->n, m->ninv);
+            if (y == m->minus_one) break;
+        }
+        if (r == m->s) return 0;
+    }
+    return 1;
+}
+
+/* Verdict from trial division by 2..37 alone, -1 when n needs the strong tests */
+static inline int mr64_small(uint64_t n) {
+    if (n < 2) return 0;
+    if (!(n & 1)) return n == 2;
+    for (size_t i = 0; i < sizeof mr64_div / sizeof mr64_div[0]; i++)
+        if (n * mr64_div[i].inv <= mr64_div[i].lim) return n == mr64_div[i].p;
+    return n < 41 * 41 ? 1 : -1;
+}
+
+int u64_dispatch_enabled = 1;
+
+int miller_rabin_u64(uint64_t n) {
+    int v = mr64_small(n);
+    if (v >= 0) return v;
+
+    MR64 m;
+    m.n = n;
+    m.s = __builtin_ctzll(n - 1);
+    m.d = (n - 1) >> m.s;
+    m.ninv = n;                                 // Newton: 3 -> 96 correct bits
+    for (int i = 0; i < 5; i++) m.ninv *= 2 - n * m.ninv;
+    m.one = -n % n;
+    m.minus_one = n - m.one;
+    m.r2 = (uint64_t)((unsigned __int128)m.one * m.one % n);
+
+    for (int g = 0; g * MR64_LANES < 12; g++) {
+        if (!mr64_group(&m, &mr64_base[g * MR64_LANES])) return 0;
+        if (n < mr64_bound[g]) break;           // enough bases for this range
+    }
+    return 1;
+}
+
+/* ---- Batches of 64-bit candidates, several per vector ----
+   Every lane holds its own n (and d, s, Montgomery constants) and all lanes
+   run the same base. Exponent bits are walked up to the longest d in the
+   vector; a lane with a shorter d starts from Montgomery 1, which squaring
+   leaves unchanged, and multiplies only where its own bit is set.
+     AVX-512 IFMA: 2 x 8 lanes, n < 2^52, R = 2^52 (vpmadd52luq/huq)
+     AVX2 only:    2 x 4 lanes, n < 2^32, R = 2^32 (vpmuludq, 32x32 -> 64)
+   Larger candidates, and all of them without those extensions, take the
+   scalar path. */
+
+#define MR64_BLOCK 256          // candidates sorted into vector queues per pass
+
+// The first k bases of mr64_base are exact below mr64_psp[k - 1]
+static const uint64_t mr64_psp[] = {2047, 1373653, 25326001, 3215031751ull, 2152302898747ull,
+                                    3474749660383ull, 341550071728321ull, 341550071728321ull,
+                                    3825123056546413051ull};
+
+static inline int mr64_bases_for(uint64_t nmax) {
+    int k = 1;
+    while (nmax >= mr64_psp[k - 1]) k++;
+    return k;
+}
+
+#if defined(__AVX512F__) && defined(__AVX512IFMA__)
+#include <immintrin.h>
+#define MR64_VEC mr52_vec
+#define MR64_VEC_W 16
+#define MR64_VEC_BITS 52
+
+static inline __m512i mr52_mul(__m512i a, __m512i b, __m512i n, __m512i ninv) {
+    const __m512i zero = _mm512_setzero_si512();
+    __m512i lo = _mm512_madd52lo_epu64(zero, a, b);
+    __m512i hi = _mm512_madd52hi_epu64(zero, a, b);
+    __m512i m = _mm512_madd52lo_epu64(zero, lo, ninv);     // -lo / n mod 2^52
+    hi = _mm512_madd52hi_epu64(hi, m, n);
+    // lo + lo52(m n) is 0 or exactly 2^52: carry one unless lo was 0
+    hi = _mm512_mask_add_epi64(hi, _mm512_test_epi64_mask(lo, lo), hi, _mm512_set1_epi64(1));
+    return _mm512_mask_sub_epi64(hi, _mm512_cmpge_epu64_mask(hi, n), hi, n);
+}
+
+/* Strong tests of 16 odd n in (41^2, 2^52) as two interleaved vectors, so
+   one chain of multiplies covers the latency of the other; bit l of the
+   result is set if n[l] is prime */
+static unsigned mr52_vec(const uint64_t *nv) {
+    uint64_t ninv[16], one[16], r2[16], d[16], s[16];
+    uint64_t dmax = 0, smax = 0, nmax = 0;
+    for (int l = 0; l < 16; l++) {
+        uint64_t n = nv[l], inv = n;
+        nmax = n > nmax ? n : nmax;
+        for (int i = 0; i < 5; i++) inv *= 2 - n * inv;
+        ninv[l] = -inv & ((1ull << 52) - 1);
+        one[l] = (1ull << 52) % n;
+        r2[l] = (uint64_t)((unsigned __int128)one[l] * one[l] % n);
+        s[l] = (uint64_t)__builtin_ctzll(n - 1);
+        d[l] = (n - 1) >> s[l];
+        dmax |= d[l];
+        smax = s[l] > smax ? s[l] : smax;
+    }
+    __m512i N[2], NI[2], ONE[2], R2[2], D[2], S[2], MONE[2], b[2], x[2];
+    for (int h = 0; h < 2; h++) {
+        N[h] = _mm512_loadu_si512(nv + 8 * h);
+        NI[h] = _mm512_loadu_si512(ninv + 8 * h);
+        ONE[h] = _mm512_loadu_si512(one + 8 * h);
+        R2[h] = _mm512_loadu_si512(r2 + 8 * h);
+        D[h] = _mm512_loadu_si512(d + 8 * h);
+        S[h] = _mm512_loadu_si512(s + 8 * h);
+        MONE[h] = _mm512_sub_epi64(N[h], ONE[h]);
+    }
+    const __m512i LSB = _mm512_set1_epi64(1);
+    __mmask8 prime[2] = {0xff, 0xff}, pass[2];
+    int bases = mr64_bases_for(nmax);
+
+    for (int i = 0; i < bases && (prime[0] | prime[1]); i++) {
+        __m512i a = _mm512_set1_epi64((long long)mr64_base[i]);
+        for (int h = 0; h < 2; h++) {
+            b[h] = mr52_mul(a, R2[h], N[h], NI[h]);
+            x[h] = ONE[h];
+        }
+        for (int j = 63 - __builtin_clzll(dmax); j >= 0; j--) {
+            for (int h = 0; h < 2; h++) {
+                x[h] = mr52_mul(x[h], x[h], N[h], NI[h]);
+                __mmask8 bit = _mm512_test_epi64_mask(_mm512_srli_epi64(D[h], (unsigned)j), LSB);
+                x[h] = _mm512_mask_mov_epi64(x[h], bit, mr52_mul(x[h], b[h], N[h], NI[h]));
+            }
+        }
+        for (int h = 0; h < 2; h++)
+            pass[h] = _mm512_cmpeq_epu64_mask(x[h], ONE[h]) | _mm512_cmpeq_epu64_mask(x[h], MONE[h]);
+        for (uint64_t r = 1; r < smax; r++) {
+            __m512i rr = _mm512_set1_epi64((long long)r);
+            for (int h = 0; h < 2; h++) {
+                x[h] = mr52_mul(x[h], x[h], N[h], NI[h]);
+                pass[h] |= _mm512_cmpeq_epu64_mask(x[h], MONE[h]) & _mm512_cmpgt_epu64_mask(S[h], rr);
+            }
+        }
+        prime[0] &= pass[0];
+        prime[1] &= pass[1];
+    }
+    return prime[0] | (unsigned)prime[1] << 8;
+}
+
+#elif defined(__AVX2__)
+#include <immintrin.h>
+#define MR64_VEC mr32_vec
+#define MR64_VEC_W 8
+#define MR64_VEC_BITS 32
+
+/* Montgomery product with R = 2^32 for n < 2^32 in 64-bit lanes; ninv = n^-1
+   mod 2^32, high-half subtraction as in mr64_mul */
+static inline __m256i mr32_mul(__m256i a, __m256i b, __m256i n, __m256i ninv) {
+    __m256i t = _mm256_mul_epu32(a, b);
+    __m256i m = _mm256_mul_epu32(t, ninv);                  // low 32 bits used below
+    __m256i mh = _mm256_srli_epi64(_mm256_mul_epu32(m, n), 32);
+    __m256i th = _mm256_srli_epi64(t, 32);
+    __m256i u = _mm256_sub_epi64(th, mh);
+    return _mm256_add_epi64(u, _mm256_and_si256(_mm256_cmpgt_epi64(mh, th), n));
+}
+
+/* 8 odd n in (41^2, 2^32) as two interleaved vectors, so one chain of
+   multiplies covers the latency of the other; bit l set if n[l] is prime */
+static unsigned mr32_vec(const uint64_t *nv) {
+    uint64_t ninv[8], one[8], r2[8], d[8], s[8];
+    uint64_t dmax = 0, smax = 0, nmax = 0;
+    for (int l = 0; l < 8; l++) {
+        uint64_t n = nv[l], inv = n;
+        nmax = n > nmax ? n : nmax;
+        for (int i = 0; i < 5; i++) inv *= 2 - n * inv;
+        ninv[l] = inv & 0xffffffffu;
+        one[l] = (1ull << 32) % n;
+        r2[l] = one[l] * one[l] % n;
+        s[l] = (uint64_t)__builtin_ctzll(n - 1);
+        d[l] = (n - 1) >> s[l];
+        dmax |= d[l];
+        smax = s[l] > smax ? s[l] : smax;
+    }
+    __m256i N[2], NI[2], ONE[2], R2[2], D[2], S[2], MONE[2], b[2], x[2], pass[2];
+    for (int h = 0; h < 2; h++) {
+        N[h] = _mm256_loadu_si256((const __m256i *)(nv + 4 * h));
+        NI[h] = _mm256_loadu_si256((const __m256i *)(ninv + 4 * h));
+        ONE[h] = _mm256_loadu_si256((const __m256i *)(one + 4 * h));
+        R2[h] = _mm256_loadu_si256((const __m256i *)(r2 + 4 * h));
+        D[h] = _mm256_loadu_si256((const __m256i *)(d + 4 * h));
+        S[h] = _mm256_loadu_si256((const __m256i *)(s + 4 * h));
+        MONE[h] = _mm256_sub_epi64(N[h], ONE[h]);
+    }
+    const __m256i LSB = _mm256_set1_epi64x(1);
+    unsigned prime = 0xff;
+    int bases = mr64_bases_for(nmax);
+
+    for (int i = 0; i < bases && prime; i++) {
+        __m256i a = _mm256_set1_epi64x((long long)mr64_base[i]);
+        for (int h = 0; h < 2; h++) {
+            b[h] = mr32_mul(a, R2[h], N[h], NI[h]);
+            x[h] = ONE[h];
+        }
+        for (int j = 63 - __builtin_clzll(dmax); j >= 0; j--) {
+            for (int h = 0; h < 2; h++) {
+                x[h] = mr32_mul(x[h], x[h], N[h], NI[h]);
+                __m256i bit = _mm256_cmpeq_epi64(_mm256_and_si256(_mm256_srli_epi64(D[h], j), LSB), LSB);
+                x[h] = _mm256_blendv_epi8(x[h], mr32_mul(x[h], b[h], N[h], NI[h]), bit);
+            }
+        }
+        for (int h = 0; h < 2; h++)
+            pass[h] = _mm256_or_si256(_mm256_cmpeq_epi64(x[h], ONE[h]), _mm256_cmpeq_epi64(x[h], MONE[h]));
+        for (uint64_t r = 1; r < smax; r++) {
+            __m256i rr = _mm256_set1_epi64x((long long)r);
+            for (int h = 0; h < 2; h++) {
+                x[h] = mr32_mul(x[h], x[h], N[h], NI[h]);
+                __m256i live = _mm256_cmpgt_epi64(S[h], rr);
+                pass[h] = _mm256_or_si256(pass[h], _mm256_and_si256(_mm256_cmpeq_epi64(x[h], MONE[h]), live));
+            }
+        }
+        prime &= (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(pass[0]))
+               | (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(pass[1])) << 4;
+    }
+    return prime;
+}
+#endif
+
+#ifdef MR64_VEC
+/* Runs full vectors from a queue of undecided candidates (indices into n);
+   a partial vector is left for the next pass unless flushing, when its spare
+   lanes repeat a live candidate */
+static size_t mr64_drain(const uint64_t *n, int *prime, size_t *q, size_t len, int flush) {
+    uint64_t lane[MR64_VEC_W];
+    size_t done = 0;
+    while (len - done >= MR64_VEC_W || (flush && done < len)) {
+        int k = len - done < MR64_VEC_W ? (int)(len - done) : MR64_VEC_W;
+        for (int l = 0; l < MR64_VEC_W; l++) lane[l] = n[q[done + (l < k ? l : 0)]];
+        unsigned bits = MR64_VEC(lane);
+        for (int l = 0; l < k; l++) prime[q[done + l]] = (int)(bits >> l & 1);
+        done += (size_t)k;
+    }
+    memmove(q, q + done, (len - done) * sizeof *q);
+    return len - done;
+}
+#endif
+
+void miller_rabin_u64_batch(const uint64_t *n, int *prime, size_t count) {
+#ifdef MR64_VEC
+    size_t q[MR64_BLOCK], len = 0;
+#endif
+    for (size_t i = 0; i < count; i++) {
+        int v = mr64_small(n[i]);
+        if (v >= 0) {
+            prime[i] = v;
+            continue;
+        }
+#ifdef MR64_VEC
+        if (n[i] >> MR64_VEC_BITS == 0) {
+            q[len++] = i;
+            if (len == MR64_BLOCK) len = mr64_drain(n, prime, q, len, 0);
+            continue;
+        }
+#endif
+        prime[i] = miller_rabin_u64(n[i]);
+    }
+#ifdef MR64_VEC
+    mr64_drain(n, prime, q, len, 1);
+#endif
+}
+
+/* ---- Per-thread scratch ---- */
+
+void primality_ctx_init(PRIMALITY_CTX *c) {
+    mpz_inits(c->n_minus1, c->d, c->a, c->x, c->U, c->V, c->Qk, c->t, NULL);
+}
+
+void primality_ctx_init2(PRIMALITY_CTX *c, mp_bitcnt_t bits) {
+    // n - 1, d and the bases stay below n; products and Lucas terms reach 2 * bits
+    mpz_init2(c->n_minus1, bits);
+    mpz_init2(c->d, bits);
+    mpz_init2(c->a, bits);
+    mpz_init2(c->x, 2 * bits + 64);
+    mpz_init2(c->U, 2 * bits + 64);
+    mpz_init2(c->V, 2 * bits + 64);
+    mpz_init2(c->Qk, 2 * bits + 64);
+    mpz_init2(c->t, 2 * bits + 64);
+}
+
+void primality_ctx_clear(PRIMALITY_CTX *c) {
+    mpz_clears(c->n_minus1, c->d, c->a, c->x, c->U, c->V, c->Qk, c->t, NULL);
 }
 
 // Miller–Rabin test
-int miller_rabin(const mpz_t n, int k, gmp_randstate_t rng) {
+int miller_rabin_ctx(const mpz_t n, int k, gmp_randstate_t rng, PRIMALITY_CTX *c) {
     // Handle small numbers explicitly
     if (mpz_cmp_ui(n, 2) < 0) return 0;          // n < 2 → composite
     if (mpz_cmp_ui(n, 2) == 0) return 1;         // 2 → prime
     if (mpz_cmp_ui(n, 3) == 0) return 1;         // 3 → prime
     if (mpz_even_p(n)) return 0;                 // even > 2 → composite
+    if (u64_dispatch_enabled && mpz_size(n) == 1)
+        return miller_rabin_u64(mpz_getlimbn(n, 0));   // proven, no GMP
+    if (trial_div_enabled && !trial_div_pass(n, c->t)) return 0;   // factor below 2^16
 
-    mpz_t n_minus1, d, a, x;
-    mpz_inits(n_minus1, d, a, x, NULL);
+    MONT_CTX ctx;
+    ctx.limbs = 0;
+    if (powm_backend == POWM_MONT) mont_ctx_init(&ctx, n);
 
-    mpz_sub_ui(n_minus1, n, 1);
-    mpz_set(d, n_minus1);
+    mpz_sub_ui(c->n_minus1, n, 1);
+    unsigned long r = mr_split(c->d, c->n_minus1);
 
-    unsigned long r = 0;
-    while (mpz_even_p(d)) {
-        mpz_fdiv_q_2exp(d, d, 1); // d /= 2
-        r++;
+    int prime = 1;
+    for (int i = 0; i < k && prime; i++) {
+        mr_base(c->a, c->n_minus1, rng);
+        prime = mr_round(c->x, c->a, c->d, r, n, c->n_minus1, &ctx, NULL);
     }
+    return prime; // 1 = probably prime, 0 = composite
+}
 
-    for (int i = 0; i < k; i++) {
-        // Random base a ∈ [2, n-2]
-        mpz_urandomm(a, rng, n_minus1);
-        mpz_add_ui(a, a, 1);
-        if (mpz_cmp_ui(a, 2) < 0) mpz_add_ui(a, a, 2);
+int miller_rabin(const mpz_t n, int k, gmp_randstate_t rng) {
+    PRIMALITY_CTX c;
+    primality_ctx_init(&c);
+    int prime = miller_rabin_ctx(n, k, rng, &c);
+    primality_ctx_clear(&c);
+    return prime;
+}
 
-        // Compute x = a^d mod n
-        mod_exp(x, a, d, n);
+int miller_rabin_base(const mpz_t n, unsigned long a, PRIMALITY_CTX *c) {
+    MONT_CTX ctx;
+    ctx.limbs = 0;
+    if (powm_backend == POWM_MONT) mont_ctx_init(&ctx, n);
 
-        if (mpz_cmp_ui(x, 1) == 0 || mpz_cmp(x, n_minus1) == 0)
-            continue;
+    mpz_set_ui(c->a, a);
+    mpz_sub_ui(c->n_minus1, n, 1);
+    unsigned long r = mr_split(c->d, c->n_minus1);
+    return mr_round(c->x, c->a, c->d, r, n, c->n_minus1, &ctx, NULL);
+}
 
-        int cont_flag = 0;
-        for (unsigned long j = 1; j < r; j++) {
-            mpz_powm_ui(x, x, 2, n); // x = x^2 mod n
+/* ---- Rounds spread over threads ---- */
 
-            if (mpz_cmp(x, n_minus1) == 0) {
-                cont_flag = 1;
-                break;
-            }
-        }
-        if (!cont_flag) {
-            mpz_clears(n_minus1, d, a, x, NULL);
-            return 0; // Composite
-        }
+typedef struct {
+    mpz_srcptr n, n_minus1, d;
+    unsigned long r;
+    const MONT_CTX *ctx;
+    int k;
+    atomic_int next;            // next unclaimed round
+    atomic_int witness;         // set by the first thread that finds one
+} MR_SHARED;
+
+typedef struct {
+    MR_SHARED *sh;
+    unsigned long seed;
+    pthread_t tid;
+} MR_WORKER;
+
+static void *mr_worker(void *arg) {
+    MR_WORKER *w = arg;
+    MR_SHARED *sh = w->sh;
+    gmp_randstate_t rng;
+    gmp_randinit_mt(rng);
+    gmp_randseed_ui(rng, w->seed);
+    mpz_t a, x;
+    mpz_init2(a, mpz_sizeinbase(sh->n, 2));
+    mpz_init2(x, 2 * mpz_sizeinbase(sh->n, 2));
+
+    while (!atomic_load_explicit(&sh->witness, memory_order_relaxed)
+           && atomic_fetch_add(&sh->next, 1) < sh->k) {
+        mr_base(a, sh->n_minus1, rng);
+        if (!mr_round(x, a, sh->d, sh->r, sh->n, sh->n_minus1, sh->ctx, &sh->witness))
+            atomic_store(&sh->witness, 1);
+    }
+
+    mpz_clears(a, x, NULL);
+    gmp_randclear(rng);
+    return NULL;
+}
+
+int miller_rabin_mt(const mpz_t n, int k, int threads, gmp_randstate_t rng) {
+    if (threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads > k) threads = k;
+    if (threads <= 1 || mpz_size(n) <= 1 || mpz_even_p(n))
+        return miller_rabin(n, k, rng);
+    if (trial_div_enabled && !trial_div_pass(n, NULL)) return 0;
+
+    MONT_CTX ctx;
+    ctx.limbs = 0;
+    if (powm_backend == POWM_MONT) mont_ctx_init(&ctx, n);
+
+    mpz_t n_minus1, d;
+    mpz_inits(n_minus1, d, NULL);
+    mpz_sub_ui(n_minus1, n, 1);
+
+    MR_SHARED sh = {.n = n, .n_minus1 = n_minus1, .d = d, .ctx = &ctx, .k = k};
+    sh.r = mr_split(d, n_minus1);
+    atomic_init(&sh.next, 0);
+    atomic_init(&sh.witness, 0);
+
+    // one seed per thread from the caller's state; the caller runs worker 0
+    MR_WORKER *w = malloc((size_t)threads * sizeof *w);
+    if (!w) {
+        mpz_clears(n_minus1, d, NULL);
+        return miller_rabin(n, k, rng);
+    }
+    int started = 0;
+    for (int t = 0; t < threads; t++) {
+        w[t].sh = &sh;
+        w[t].seed = gmp_urandomb_ui(rng, 32);
     }
+    for (int t = 1; t < threads; t++, started++)
+        if (pthread_create(&w[t].tid, NULL, mr_worker, &w[t]) != 0) break;
+    mr_worker(&w[0]);
+    for (int t = 1; t <= started; t++) pthread_join(w[t].tid, NULL);
+    free(w);
 
-    mpz_clears(n_minus1, d, a, x, NULL);
-    return 1; // Probably prime
+    int prime = !atomic_load(&sh.witness);
+    mpz_clears(n_minus1, d, NULL);
+    return prime;
 }
 
+#ifndef CRYPTO_NO_MAIN
 // Generate a probable prime of given bits
-void generate_prime(mpz_t prime, int bits, gmp_randstate_t rng) {
+static void generate_prime(mpz_t prime, int bits, gmp_randstate_t rng) {
+    PRIME_SEARCH ps;
+    prime_search_init(&ps);
     mpz_urandomb(prime, rng, bits);
     mpz_setbit(prime, bits - 1);   // Ensure it's "bits"-bit
-    mpz_nextprime(prime, prime);   // Next prime
+    prime_search_start(&ps, prime);
+    prime_search_find(&ps, prime, 25, 0, NULL);   // Next prime, small primes sieved out
+    prime_search_clear(&ps);
+}
+
+/* miller-rabin --scale [bits=2048] [k=40] [max_threads=nproc]: latency of
+   miller_rabin_mt on a prime (all k rounds run) and on a composite (first
+   witness aborts the rest) for 1, 2, 4, ... threads */
+static int mr_scale(int argc, char **argv) {
+    int bits    = argc > 0 ? atoi(argv[0]) : 2048;
+    int k       = argc > 1 ? atoi(argv[1]) : 40;
+    int max_thr = argc > 2 ? atoi(argv[2]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (bits < 64 || k < 1 || max_thr < 1) {
+        fprintf(stderr, "Usage: miller-rabin --scale [bits] [k] [max_threads]\n");
+        return 1;
+    }
+
+    ct_init();
+    gmp_randstate_t rng;
+    gmp_randinit_mt(rng);
+    gmp_randseed_ui(rng, 0x5EED);
+    mpz_t prime, comp, q;
+    mpz_inits(prime, comp, q, NULL);
+    generate_prime(prime, bits, rng);
+    generate_prime(comp, bits / 2, rng);
+    generate_prime(q, bits - bits / 2, rng);
+    mpz_mul(comp, comp, q);
+
+    printf("Miller-Rabin, %d-bit n, k=%d\n", bits, k);
+    printf("%8s %16s %9s %16s\n", "threads", "prime cycles", "speedup", "composite cycles");
+    int failed = 0;
+    double base = 0;
+    for (int t = 1; t <= max_thr; t = t < max_thr && 2 * t > max_thr ? max_thr : 2 * t) {
+        CT_STATS sp, sc;
+        ct_stats_reset(&sp);
+        ct_stats_reset(&sc);
+        for (int rep = 0; rep < 3; rep++) {
+            uint64_t t0 = ct_start();
+            failed |= miller_rabin_mt(prime, k, t, rng) != 1;
+            ct_stats_add(&sp, ct_elapsed(t0, ct_stop()));
+            t0 = ct_start();
+            failed |= miller_rabin_mt(comp, k, t, rng) != 0;
+            ct_stats_add(&sc, ct_elapsed(t0, ct_stop()));
+        }
+        if (t == 1) base = ct_stats_avg(&sp);
+        printf("%8d %16.0f %8.2fx %16.0f\n", t, ct_stats_avg(&sp), base / ct_stats_avg(&sp),
+               ct_stats_avg(&sc));
+        char label[32];
+        snprintf(label, sizeof label, "prime_t%d", t);
+        ct_csv_report("miller_rabin_mt", label, (size_t)bits, &sp, NULL);
+        snprintf(label, sizeof label, "composite_t%d", t);
+        ct_csv_report("miller_rabin_mt", label, (size_t)bits, &sc, NULL);
+    }
+    printf("Result: %s\n", failed ? "WRONG VERDICT" : "all verdicts correct");
+
+    mpz_clears(prime, comp, q, NULL);
+    gmp_randclear(rng);
+    return failed;
 }
 
-int main() {
+/* miller-rabin --bench64 [count=200000]: miller_rabin_u64 against GMP's
+   mpz_probab_prime_p (exact below 2^64) on random odd 64-bit numbers and on
+   64-bit primes, the worst case */
+static int mr_bench64(int argc, char **argv) {
+    long count = argc > 0 ? atol(argv[0]) : 200000;
+    if (count < 1) {
+        fprintf(stderr, "Usage: miller-rabin --bench64 [count]\n");
+        return 1;
+    }
+
+    ct_init();
+    gmp_randstate_t rng;
+    gmp_randinit_mt(rng);
+    gmp_randseed_ui(rng, 0x64B17);
+    uint64_t *num = malloc((size_t)count * sizeof *num);
+    int *verdict = malloc((size_t)count * sizeof *verdict);
+    mpz_t n;
+    mpz_init(n);
+    int failed = 0;
+
+    // the batch call vectorises below 2^32 (AVX2) and 2^52 (IFMA)
+    static const int width[] = {32, 52, 64};
+    printf("%-16s %12s %14s %12s %9s\n", "inputs", "u64 ns/test", "batch ns/test",
+           "GMP ns/test", "speedup");
+    for (int w = 0; w < 3; w++)
+    for (int primes = 0; primes < 2; primes++) {
+        int bits = width[w];
+        for (long i = 0; i < count; i++) {
+            mpz_urandomb(n, rng, (mp_bitcnt_t)bits);
+            mpz_setbit(n, 0);
+            if (primes) {
+                mpz_clrbit(n, (mp_bitcnt_t)bits - 1);   // room for nextprime
+                mpz_setbit(n, (mp_bitcnt_t)bits - 2);
+                mpz_nextprime(n, n);
+            }
+            num[i] = mpz_getlimbn(n, 0);
+        }
+
+        long found = 0;
+        uint64_t t0 = ct_start();
+        for (long i = 0; i < count; i++) found += miller_rabin_u64(num[i]);
+        double t_u64 = (double)ct_elapsed(t0, ct_stop());
+
+        t0 = ct_start();
+        miller_rabin_u64_batch(num, verdict, (size_t)count);
+        double t_batch = (double)ct_elapsed(t0, ct_stop());
+        long found_batch = 0;
+        for (long i = 0; i < count; i++) found_batch += verdict[i];
+        failed |= found_batch != found;
+
+        long found_gmp = 0;
+        t0 = ct_start();
+        for (long i = 0; i < count; i++) {
+            mpz_set_ui(n, num[i]);
+            int v = mpz_probab_prime_p(n, 12) != 0;
+            found_gmp += v;
+            failed |= v != miller_rabin_u64(num[i]) || v != verdict[i];
+        }
+        double t_gmp = (double)ct_elapsed(t0, ct_stop());
+        failed |= found != found_gmp;
+
+        double ns = 1e9 / ct_hz() / (double)count;
+        char label[32];
+        snprintf(label, sizeof label, "%d-bit %s", bits, primes ? "primes" : "odd");
+        printf("%-16s %12.1f %14.1f %12.1f %8.2fx\n", label, t_u64 * ns, t_batch * ns,
+               t_gmp * ns, t_gmp / (t_batch < t_u64 ? t_batch : t_u64));
+    }
+
+    // strong pseudoprimes to the shorter base sets sit right at the range bounds
+    static const uint64_t psp[] = {2047, 1373653, 25326001, 3215031751ull, 2152302898747ull,
+                                   3474749660383ull, 341550071728321ull, 3825123056546413051ull};
+    for (size_t i = 0; i < sizeof psp / sizeof psp[0]; i++) failed |= miller_rabin_u64(psp[i]);
+    failed |= !miller_rabin_u64(18446744073709551557ull);   // largest 64-bit prime
+    int psp_batch[sizeof psp / sizeof psp[0]];
+    miller_rabin_u64_batch(psp, psp_batch, sizeof psp / sizeof psp[0]);
+    for (size_t i = 0; i < sizeof psp / sizeof psp[0]; i++) failed |= psp_batch[i];
+
+    printf("Result: %s\n", failed ? "MISMATCH" : "all verdicts match mpz_probab_prime_p");
+    mpz_clear(n);
+    free(verdict);
+    free(num);
+    gmp_randclear(rng);
+    return failed;
+}
+
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "--scale") == 0)
+        return mr_scale(argc - 2, argv + 2);
+    if (argc > 1 && strcmp(argv[1], "--bench64") == 0)
+        return mr_bench64(argc - 2, argv + 2);
+    // the GMP cross-check repeats the test work, so it is opt-in
+    int gmp_cross_check = argc > 1 && strcmp(argv[1], "--gmp-check") == 0;
+
     mpz_t n;
     mpz_init(n);
     gmp_randstate_t rng;
@@ -93,17 +706,20 @@ int main() {
         mpz_set_str(n, input, 10);
     }
 
-    printf("Enter number of iterations k: ");
+    printf("Enter number of iterations k (0 = BPSW, no k needed): ");
     if (scanf("%d", &k) != 1) return 1;
 
-    unsigned long long start = __rdtsc();
-    int is_probably_prime = miller_rabin(n, k, rng);
-    unsigned long long end = __rdtsc();
+    ct_init();
+    uint64_t start = ct_start();
+    int is_probably_prime = k > 0 ? miller_rabin(n, k, rng) : bpsw(n);
+    uint64_t end = ct_stop();
 
-    unsigned long long total_cycles = end - start;
-    double avg_cycles = (k > 0) ? ((double) total_cycles / k) : 0.0;
+    unsigned long long total_cycles = ct_elapsed(start, end);
+    double avg_cycles = (k > 0) ? ((double) total_cycles / k) : (double) total_cycles;
 
-    if (is_probably_prime) {
+    if (is_probably_prime && k <= 0) {
+        printf("Result: PROBABLY PRIME (BPSW)\n");
+    } else if (is_probably_prime) {
         printf("Result: PROBABLY PRIME (k=%d, error ≤ 4^-%d)\n", k, k);
     } else {
         printf("Result: COMPOSITE\n");
@@ -112,13 +728,22 @@ int main() {
     printf("Total cycles: %llu\n", total_cycles);
     printf("Average cycles per iteration: %.2f\n", avg_cycles);
 
-    // Cross-check with GMP built-in test
-    int gmp_check = mpz_probab_prime_p(n, 25);
-    if (gmp_check == 0) printf("[GMP check] Definitely COMPOSITE\n");
-    else if (gmp_check == 1) printf("[GMP check] Probably PRIME\n");
-    else if (gmp_check == 2) printf("[GMP check] Definitely PRIME\n");
+    CT_STATS stats;
+    ct_stats_reset(&stats);
+    ct_stats_add(&stats, total_cycles);
+    ct_csv_report(k > 0 ? "miller_rabin" : "bpsw", is_probably_prime ? "prime" : "composite",
+                  mpz_sizeinbase(n, 2), &stats, NULL);
+
+    // Cross-check with GMP built-in test (--gmp-check)
+    if (gmp_cross_check) {
+        int gmp_check = mpz_probab_prime_p(n, 25);
+        if (gmp_check == 0) printf("[GMP check] Definitely COMPOSITE\n");
+        else if (gmp_check == 1) printf("[GMP check] Probably PRIME\n");
+        else if (gmp_check == 2) printf("[GMP check] Definitely PRIME\n");
+    }
 
     mpz_clear(n);
     gmp_randclear(rng);
     return 0;
 }
+#endif /* CRYPTO_NO_MAIN */
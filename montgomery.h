@@ -0,0 +1,69 @@
+// montgomery.h
+// Fixed-width Montgomery arithmetic for 512..2048-bit odd moduli.
+//
+// Kernels are specialised at compile time for 8, 12, 16 and 32 64-bit limbs
+// (512, 768, 1024 and 2048 bits). All operands live in stack arrays of the
+// kernel width; products go through GMP's mpn_mul_n / mpn_sqr and a
+// word-by-word REDC on mpn_addmul_1. Exponentiation is left-to-right sliding
+// window. A modulus is padded up to the next kernel width, so any odd
+// modulus of at most 2048 bits is accepted.
+
+#ifndef MONTGOMERY_H
+#define MONTGOMERY_H
+
+#include <stddef.h>
+#include <gmp.h>
+
+#define MONT_MAX_LIMBS 32
+#define MONT_MAX_BASES 4                // bases per mont_ctx_powm_pm1 call
+
+typedef struct {
+    int limbs;                          // kernel width: 8, 12, 16 or 32
+    mp_limb_t ninv;                     // -n^-1 mod 2^64
+    mp_limb_t n[MONT_MAX_LIMBS];        // modulus, zero-padded to `limbs`
+    mp_limb_t r2[MONT_MAX_LIMBS];       // R^2 mod n, R = 2^(64 * limbs)
+} MONT_CTX;
+
+// Smallest kernel width holding `limbs` limbs, 0 if there is none
+int mont_width(size_t limbs);
+
+// -n0^-1 mod 2^64 for odd n0, the REDC multiplier of a modulus with low limb n0
+mp_limb_t mont_ninv(mp_limb_t n0);
+
+// r = t / 2^(64 * len) mod n for t < n * 2^(64 * len), with ninv = mont_ninv(n[0]).
+// t has 2 * len limbs and is clobbered. Any len works; the kernel widths
+// take the same (ADX) rows as the exponentiation kernels.
+void mont_reduce(mp_limb_t *r, mp_limb_t *t, const mp_limb_t *n, mp_size_t len, mp_limb_t ninv);
+
+// Returns 0, or -1 (and limbs = 0) when n is even, 1, or wider than
+// MONT_MAX_LIMBS limbs
+int mont_ctx_init(MONT_CTX *ctx, const mpz_t n);
+
+// r = b^e mod n for a context built by mont_ctx_init (e >= 0)
+void mont_ctx_powm(mpz_t r, const mpz_t b, const mpz_t e, const MONT_CTX *ctx);
+
+// For count <= MONT_MAX_BASES bases b[i] in [0, n) sharing the exponent e > 0:
+// sign[i] = 1 if b[i]^e == 1 mod n, -1 if it is n - 1, 0 otherwise. The
+// bases run interleaved through one pass over e (each squaring and window
+// multiply is issued for all of them back to back, so their carry chains
+// overlap) and the results are compared in Montgomery form, never converted.
+void mont_ctx_powm_pm1(int *sign, const mpz_srcptr *b, int count, const mpz_t e, const MONT_CTX *ctx);
+
+// One-shot: builds the context on the stack; falls back to mpz_powm for
+// moduli or exponents the kernels do not cover
+void mont_powm(mpz_t r, const mpz_t b, const mpz_t e, const mpz_t n);
+
+// Backend for the modular exponentiations in RSA and the primality tests
+typedef enum { POWM_GMP, POWM_MONT } POWM_BACKEND;
+extern POWM_BACKEND powm_backend;
+
+// r = b^e mod n through the selected backend
+void crypto_powm(mpz_t r, const mpz_t b, const mpz_t e, const mpz_t n);
+
+// Same, reusing a context built once for n: the Montgomery backend skips
+// n^-1 and R^2 mod n on every call. ctx may be NULL or have limbs == 0,
+// which takes the plain crypto_powm path.
+void crypto_powm_ctx(mpz_t r, const mpz_t b, const mpz_t e, const mpz_t n,
+                     const MONT_CTX *ctx);
+
+#endif /* MONTGOMERY_H */
@@ -0,0 +1,21 @@
+// multiversion.h
+// Function multiversioning for the hot kernels.
+//
+// With -DCRYPTO_FMV (the Makefile default) GCC emits one clone of each marked
+// function per x86-64 micro-architecture level and an ifunc resolver picks
+// the best one at load time, so a single library built for baseline x86-64
+// still runs AVX2/AVX-512 code where available. Without CRYPTO_FMV, or on
+// other compilers/targets, the marker expands to nothing and the -march the
+// file was compiled with decides.
+
+#ifndef MULTIVERSION_H
+#define MULTIVERSION_H
+
+#if defined(CRYPTO_FMV) && defined(__GNUC__) && !defined(__clang__) && defined(__x86_64__) \
+    && defined(__linux__)
+  #define CRYPTO_KERNEL __attribute__((target_clones("arch=x86-64-v4", "arch=x86-64-v3", "default")))
+#else
+  #define CRYPTO_KERNEL
+#endif
+
+#endif /* MULTIVERSION_H */
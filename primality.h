@@ -0,0 +1,73 @@
+// primality.h
+// Probabilistic primality tests on GMP integers.
+//   miller_rabin()      miller-rabin.c      error <= 4^-k
+//   solovay_strassen()  solovey-stressan.c  error <= 2^-k
+//   miller_rabin_mt()   miller-rabin.c      same test, rounds spread over threads
+//   bpsw()              bpsw.c              Baillie-PSW, no k; the fast default
+// All return 1 for "probably prime", 0 for composite. The randomized tests
+// draw their bases from the caller's gmp_randstate_t (one state per thread).
+
+#ifndef PRIMALITY_H
+#define PRIMALITY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <gmp.h>
+
+// Jacobi symbol (a/n) for odd n > 0, shared by Solovay-Strassen and BPSW
+static inline __attribute__((always_inline))
+int jacobi_symbol(const mpz_t a, const mpz_t n) {
+    return mpz_jacobi(a, n);
+}
+
+int miller_rabin(const mpz_t n, int k, gmp_randstate_t rng);
+int solovay_strassen(const mpz_t n, int k, gmp_randstate_t rng);
+
+// The k rounds of miller_rabin claimed one at a time by `threads` workers
+// (<= 0: every online CPU), each with its own gmp_randstate_t seeded from
+// rng. The first witness found stops all workers, including one midway
+// through its squaring loop. For large n and k, where rounds are long.
+int miller_rabin_mt(const mpz_t n, int k, int threads, gmp_randstate_t rng);
+
+// Scratch integers for one thread's tests. The *_ctx variants reuse them
+// across calls instead of mpz_inits/mpz_clears per test (the plain functions
+// wrap one around every call). Not shared between threads.
+typedef struct {
+    mpz_t n_minus1, d, a, x;    // Miller-Rabin / Solovay-Strassen rounds
+    mpz_t U, V, Qk, t;          // Lucas sequence, gcd scratch
+} PRIMALITY_CTX;
+
+void primality_ctx_init(PRIMALITY_CTX *c);
+// Pre-sized (mpz_init2) for candidates up to `bits` bits: no reallocation on
+// the first tests either
+void primality_ctx_init2(PRIMALITY_CTX *c, mp_bitcnt_t bits);
+void primality_ctx_clear(PRIMALITY_CTX *c);
+
+int miller_rabin_ctx(const mpz_t n, int k, gmp_randstate_t rng, PRIMALITY_CTX *c);
+int solovay_strassen_ctx(const mpz_t n, int k, gmp_randstate_t rng, PRIMALITY_CTX *c);
+int bpsw_ctx(const mpz_t n, PRIMALITY_CTX *c);
+
+// Deterministic Miller-Rabin for n < 2^64 on native words (unsigned __int128
+// Montgomery products, bases 2, 3, 5, ..., 37 cut short by the range of n):
+// a proven answer in well under a microsecond. The tests above dispatch to
+// it for one-limb n.
+int miller_rabin_u64(uint64_t n);
+
+// Set to 0 to keep one-limb n on the multi-precision rounds instead of
+// miller_rabin_u64 (benchmarks that time or count single rounds at 64 bits;
+// n must stay above 2^16)
+extern int u64_dispatch_enabled;
+
+// prime[i] = miller_rabin_u64(n[i]) for i < count, several candidates per
+// vector: 2 x 8 lanes with AVX-512 IFMA for n < 2^52, 2 x 4 lanes with AVX2
+// for n < 2^32, the scalar path for the rest or without those extensions
+void miller_rabin_u64_batch(const uint64_t *n, int *prime, size_t count);
+
+// One strong probable-prime round to the fixed base a, for odd n > a + 1
+int miller_rabin_base(const mpz_t n, unsigned long a, PRIMALITY_CTX *c);
+
+// Baillie-PSW: deterministic, about the cost of three Miller-Rabin rounds,
+// with no known counterexample (none below 2^64)
+int bpsw(const mpz_t n);
+
+#endif /* PRIMALITY_H */
@@ -0,0 +1,296 @@
+/*
+Batch primality engine (see prime_batch.h) plus a file-screening front end.
+
+To compile:
+    make prime_batch
+
+To run:
+    ./build/bin/prime_batch [-t threads] [-k rounds] [-o out.csv] [file ...]
+
+Reads newline-separated candidates (decimal, or hex with 0x) from the files,
+or stdin when none is given, and writes one CSV row per candidate:
+    index,verdict,bits,cycles,n   (index counts non-blank lines from 1;
+                                   n is quoted if it holds a comma or quote)
+-k 0 (the default) tests with BPSW, -k N with N Miller-Rabin rounds. A
+summary goes to stderr.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <gmp.h>
+
+#include "prime_batch.h"
+#include "worker_pool.h"
+#include "primality.h"
+#include "trial_div.h"
+#include "cycle_timer.h"
+
+typedef struct {
+    PRIME_BATCH *b;
+    PRIMALITY_CTX ctx;          // per-thread arena: lives as long as the pool
+    mpz_t n;
+    gmp_randstate_t rng;
+} PB_WORKER;
+
+struct PRIME_BATCH {
+    WORKER_POOL pool;
+    int k;
+    PB_WORKER *workers;
+
+    // current batch
+    char *const *lines;
+    PB_RESULT *res;
+    size_t count;
+    atomic_size_t next;         // next unclaimed line
+};
+
+/* Strips surrounding whitespace and picks the base; 0 if s is not a number.
+   Only digits of the base may remain: mpz_set_str would also take a sign
+   and skip whitespace inside the number. */
+static int pb_parse(mpz_t n, const char *s) {
+    while (isspace((unsigned char)*s)) s++;
+    size_t len = strlen(s);
+    while (len && isspace((unsigned char)s[len - 1])) len--;
+    if (!len) return 0;
+
+    int base = 10;
+    if (len > 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X')) {
+        base = 16;
+        s += 2;
+        len -= 2;
+    }
+    for (size_t i = 0; i < len; i++)
+        if (!(base == 16 ? isxdigit((unsigned char)s[i]) : isdigit((unsigned char)s[i])))
+            return 0;
+    char buf[256];
+    char *tmp = len < sizeof buf ? buf : malloc(len + 1);
+    if (!tmp) return 0;
+    memcpy(tmp, s, len);
+    tmp[len] = '\0';
+    int ok = mpz_set_str(n, tmp, base) == 0;
+    if (tmp != buf) free(tmp);
+    return ok;
+}
+
+static void pb_item(PB_WORKER *w, size_t i) {
+    PRIME_BATCH *b = w->b;
+    PB_RESULT *r = &b->res[i];
+    if (!pb_parse(w->n, b->lines[i])) {
+        r->verdict = PB_INVALID;
+        r->bits = 0;
+        r->cycles = 0;
+        return;
+    }
+    r->bits = (unsigned)mpz_sizeinbase(w->n, 2);
+    uint64_t t0 = ct_start();
+    r->verdict = b->k > 0 ? miller_rabin_ctx(w->n, b->k, w->rng, &w->ctx)
+                          : bpsw_ctx(w->n, &w->ctx);
+    r->cycles = ct_elapsed(t0, ct_stop());
+}
+
+static void pb_drain(PB_WORKER *w) {
+    PRIME_BATCH *b = w->b;
+    for (;;) {
+        size_t lo = atomic_fetch_add(&b->next, PB_CHUNK);
+        if (lo >= b->count) return;
+        size_t hi = lo + PB_CHUNK < b->count ? lo + PB_CHUNK : b->count;
+        for (size_t i = lo; i < hi; i++) pb_item(w, i);
+    }
+}
+
+static void pb_job(void *arg, int id) {
+    PRIME_BATCH *b = arg;
+    pb_drain(&b->workers[id]);
+}
+
+static void pb_worker_clear(PB_WORKER *w) {
+    primality_ctx_clear(&w->ctx);
+    mpz_clear(w->n);
+    gmp_randclear(w->rng);
+}
+
+PRIME_BATCH *prime_batch_create(int threads, int k, unsigned long seed) {
+    threads = worker_pool_size(threads);
+    PRIME_BATCH *b = calloc(1, sizeof *b);
+    if (!b) return NULL;
+    b->workers = calloc((size_t)threads, sizeof *b->workers);
+    if (!b->workers) { free(b); return NULL; }
+    b->k = k;
+    atomic_init(&b->next, 0);
+    ct_init();
+    trial_div_init();
+
+    for (int i = 0; i < threads; i++) {
+        PB_WORKER *w = &b->workers[i];
+        w->b = b;
+        primality_ctx_init(&w->ctx);
+        mpz_init(w->n);
+        gmp_randinit_mt(w->rng);
+        gmp_randseed_ui(w->rng, seed + (unsigned long)i);
+    }
+    // candidates are claimed from one cursor, so any number of workers will do
+    int started = worker_pool_start(&b->pool, threads, pb_job, b);
+    for (int i = started; i < threads; i++) pb_worker_clear(&b->workers[i]);
+    if (started == 0) {
+        free(b->workers);
+        free(b);
+        return NULL;
+    }
+    return b;
+}
+
+void prime_batch_destroy(PRIME_BATCH *b) {
+    if (!b) return;
+    int n = b->pool.nthreads;
+    worker_pool_stop(&b->pool);
+    for (int i = 0; i < n; i++) pb_worker_clear(&b->workers[i]);
+    free(b->workers);
+    free(b);
+}
+
+int prime_batch_threads(const PRIME_BATCH *b) {
+    return b->pool.nthreads;
+}
+
+void prime_batch_run(PRIME_BATCH *b, char *const *lines, size_t count, PB_RESULT *res) {
+    b->lines = lines;
+    b->res = res;
+    b->count = count;
+    atomic_store(&b->next, 0);
+
+    // too small to be worth waking the pool
+    if (b->pool.nthreads == 1 || count <= PB_CHUNK) {
+        pb_drain(&b->workers[0]);
+        return;
+    }
+    worker_pool_run(&b->pool);
+}
+
+/* ---- File front end ---- */
+
+#ifndef CRYPTO_NO_MAIN
+#define PB_BLOCK 4096           // lines per batch
+
+typedef struct {
+    size_t line, primes, composites, invalid;
+    uint64_t cycles;
+} PB_TOTALS;
+
+/* The input line as the last CSV field, quoted when it holds a comma or quote */
+static void pb_csv_field(FILE *out, const char *s) {
+    if (!strpbrk(s, ",\"")) {
+        fputs(s, out);
+        return;
+    }
+    fputc('"', out);
+    for (; *s; s++) {
+        if (*s == '"') fputc('"', out);
+        fputc(*s, out);
+    }
+    fputc('"', out);
+}
+
+static void pb_flush(PRIME_BATCH *b, FILE *out, char **lines, size_t count,
+                     PB_RESULT *res, PB_TOTALS *tot) {
+    static const char *names[] = {"invalid", "composite", "prime"};
+    prime_batch_run(b, lines, count, res);
+    for (size_t i = 0; i < count; i++) {
+        tot->line++;
+        tot->cycles += res[i].cycles;
+        if (res[i].verdict == PB_PRIME) tot->primes++;
+        else if (res[i].verdict == PB_COMPOSITE) tot->composites++;
+        else tot->invalid++;
+        lines[i][strcspn(lines[i], "\r\n")] = '\0';
+        fprintf(out, "%zu,%s,%u,%llu,", tot->line, names[res[i].verdict + 1],
+                res[i].bits, (unsigned long long)res[i].cycles);
+        pb_csv_field(out, lines[i]);
+        fputc('\n', out);
+    }
+}
+
+static int pb_screen(PRIME_BATCH *b, FILE *in, FILE *out, char **lines, size_t *cap,
+                     PB_RESULT *res, PB_TOTALS *tot) {
+    size_t count = 0;
+    while (getline(&lines[count], &cap[count], in) >= 0) {
+        if (lines[count][strspn(lines[count], " \t\r\n")] == '\0') continue;   // blank
+        if (++count == PB_BLOCK) {
+            pb_flush(b, out, lines, count, res, tot);
+            count = 0;
+        }
+    }
+    if (count) pb_flush(b, out, lines, count, res, tot);
+    return ferror(in) ? -1 : 0;
+}
+
+int main(int argc, char **argv) {
+    int threads = 0, k = 0;
+    const char *out_path = NULL;
+    int opt;
+    while ((opt = getopt(argc, argv, "t:k:o:")) != -1) {
+        switch (opt) {
+        case 't': threads = atoi(optarg); break;
+        case 'k': k = atoi(optarg); break;
+        case 'o': out_path = optarg; break;
+        default:
+            fprintf(stderr, "Usage: %s [-t threads] [-k rounds (0 = BPSW)] [-o out.csv] [file ...]\n",
+                    argv[0]);
+            return 1;
+        }
+    }
+
+    FILE *out = out_path ? fopen(out_path, "w") : stdout;
+    if (!out) {
+        perror(out_path);
+        return 1;
+    }
+    PRIME_BATCH *b = prime_batch_create(threads, k, 0x9B47C3ul);
+    if (!b) {
+        fprintf(stderr, "prime_batch: cannot start the worker pool\n");
+        return 1;
+    }
+    char **lines = calloc(PB_BLOCK, sizeof *lines);
+    size_t *cap = calloc(PB_BLOCK, sizeof *cap);
+    PB_RESULT *res = calloc(PB_BLOCK, sizeof *res);
+    if (!lines || !cap || !res) {
+        fprintf(stderr, "prime_batch: out of memory\n");
+        return 1;
+    }
+
+    fprintf(out, "index,verdict,bits,cycles,n\n");
+    PB_TOTALS tot = {0};
+    int rc = 0;
+    uint64_t t0 = ct_start();
+    if (optind == argc) {
+        rc |= pb_screen(b, stdin, out, lines, cap, res, &tot) != 0;
+    }
+    for (int i = optind; i < argc; i++) {
+        FILE *in = strcmp(argv[i], "-") == 0 ? stdin : fopen(argv[i], "r");
+        if (!in) {
+            perror(argv[i]);
+            rc = 1;
+            continue;
+        }
+        rc |= pb_screen(b, in, out, lines, cap, res, &tot) != 0;
+        if (in != stdin) fclose(in);
+    }
+    double secs = (double)ct_elapsed(t0, ct_stop()) / ct_hz();
+
+    fprintf(stderr, "%zu candidates on %d threads (%s): %zu prime, %zu composite, "
+            "%zu invalid; %.0f candidates/s, %.0f test cycles/candidate\n",
+            tot.line, prime_batch_threads(b), k > 0 ? "Miller-Rabin" : "BPSW",
+            tot.primes, tot.composites, tot.invalid, secs > 0 ? tot.line / secs : 0.0,
+            tot.line ? (double)tot.cycles / tot.line : 0.0);
+
+    for (size_t i = 0; i < PB_BLOCK; i++) free(lines[i]);
+    free(lines);
+    free(cap);
+    free(res);
+    prime_batch_destroy(b);
+    if (out != stdout) fclose(out);
+    return rc;
+}
+#endif /* CRYPTO_NO_MAIN */
@@ -0,0 +1,40 @@
+// prime_batch.h
+// Batch primality screening over streams of candidates.
+//
+// A PRIME_BATCH owns a pool of worker threads. Each worker keeps its own
+// PRIMALITY_CTX, candidate integer and gmp_randstate_t for the life of the
+// pool, so a batch allocates no GMP integers per number. A batch is a block
+// of text lines (decimal, or hex with a 0x prefix); workers claim PB_CHUNK
+// lines at a time from a shared cursor, so a run of slow primes does not
+// stall one thread's static range.
+
+#ifndef PRIME_BATCH_H
+#define PRIME_BATCH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define PB_CHUNK 4              // lines claimed per queue operation
+
+enum { PB_COMPOSITE = 0, PB_PRIME = 1, PB_INVALID = -1 };
+
+typedef struct {
+    int verdict;                // PB_PRIME, PB_COMPOSITE or PB_INVALID (not a number)
+    unsigned bits;              // size of the candidate
+    uint64_t cycles;            // parse excluded, test only
+} PB_RESULT;
+
+typedef struct PRIME_BATCH PRIME_BATCH;
+
+// threads <= 0 uses every online CPU; k > 0 runs k Miller-Rabin rounds,
+// k <= 0 runs BPSW. seed feeds the per-thread random states. If some threads
+// cannot be started the pool keeps the ones that did (prime_batch_threads);
+// NULL if none start.
+PRIME_BATCH *prime_batch_create(int threads, int k, unsigned long seed);
+void prime_batch_destroy(PRIME_BATCH *b);
+int prime_batch_threads(const PRIME_BATCH *b);
+
+// Tests lines[i] for i < count (surrounding whitespace ignored) into res[i]
+void prime_batch_run(PRIME_BATCH *b, char *const *lines, size_t count, PB_RESULT *res);
+
+#endif /* PRIME_BATCH_H */
@@ -0,0 +1,459 @@
+/*
+Primality test benchmark over fixed corpora.
+
+To compile:
+    make prime_bench
+
+To run:
+    ./build/bin/prime_bench [--bits LIST] [--count N] [--rounds K] [--trials N]
+                            [--seed S] [--corpus FILE] [--format text|csv]
+                            [--out FILE] [--baseline FILE] [--tolerance PCT]
+
+For every size in --bits (default 64,128,256,512,1024,2048,4096) builds four
+corpora from a fixed seed:
+    prime       random primes
+    composite   random odd composites
+    carmichael  Chernick Carmichael numbers (6k+1)(12k+1)(18k+1)
+    spsp        strong pseudoprimes to base 2 of the form p(2p-1)
+and runs miller_rabin, solovay_strassen, bpsw and mpz_probab_prime_p over
+them with K rounds (default 25). Reported per test, corpus and size:
+    avg_cycles       one full test
+    numbers_per_sec  throughput
+    round_cycles     one single-round test (a single call for bpsw / GMP)
+    errors           wrong verdicts with K rounds
+    liars / trials   single-round passes on composites (the empirical
+                     false-positive rate; failures on primes count as errors)
+--count is the number of 512-bit inputs per corpus, scaled by 512 / bits.
+Building the large Carmichael and pseudoprime corpora takes minutes at 4096
+bits; --corpus FILE keeps every generated number there and reuses it on the
+next run. Each number is drawn from its own seed (seed, corpus, bits, index),
+so a corpus topped up from the file is the one a fresh run would build.
+
+The tests normally hand one-limb n to miller_rabin_u64; the benchmark turns
+that off (u64_dispatch_enabled = 0), so the 64-bit rows time and count the
+same multi-precision rounds as the larger sizes.
+
+Exits 1 on any wrong verdict. With --baseline (a CSV from an earlier run),
+exits 3 when any avg_cycles is more than --tolerance percent (default 10)
+above the baseline.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <gmp.h>
+
+#include "primality.h"
+#include "prime_search.h"
+#include "prime_sieve.h"
+#include "cycle_timer.h"
+
+#define MAX_SIZES   16
+#define FAMILY_WINDOW 65536     // k values sieved at a time
+#define FAMILY_LIMIT  (1u << 20)  // primes below this are sieved out of family factors
+#define FAMILY_NPRIMES 82024    // odd primes below FAMILY_LIMIT
+
+typedef enum { CORPUS_PRIME, CORPUS_COMPOSITE, CORPUS_CARMICHAEL, CORPUS_SPSP, CORPUS_COUNT } CORPUS;
+static const char *corpus_name[CORPUS_COUNT] = {"prime", "composite", "carmichael", "spsp"};
+
+/* ---- Tests under one signature ---- */
+
+typedef int (*TEST_FN)(const mpz_t n, int k, gmp_randstate_t rng, PRIMALITY_CTX *c);
+
+static int test_bpsw(const mpz_t n, int k, gmp_randstate_t rng, PRIMALITY_CTX *c) {
+    (void)k;
+    (void)rng;
+    return bpsw_ctx(n, c);
+}
+
+static int test_gmp(const mpz_t n, int k, gmp_randstate_t rng, PRIMALITY_CTX *c) {
+    (void)rng;
+    (void)c;
+    return mpz_probab_prime_p(n, k) != 0;
+}
+
+static const struct {
+    const char *name;
+    TEST_FN fn;
+} tests[] = {
+    {"miller_rabin", miller_rabin_ctx},
+    {"solovay_strassen", solovay_strassen_ctx},
+    {"bpsw", test_bpsw},
+    {"mpz_probab_prime_p", test_gmp},
+};
+#define NTESTS ((int)(sizeof tests / sizeof tests[0]))
+
+/* ---- Corpora ---- */
+
+/* x with a * x = 1 mod q, for q prime not dividing a */
+static uint32_t inv_mod(uint32_t a, uint32_t q) {
+    int64_t r0 = q, r1 = a % q, s0 = 0, s1 = 1;
+    while (r1) {
+        int64_t t = r0 / r1, r = r0 - t * r1, s = s0 - t * s1;
+        r0 = r1, r1 = r, s0 = s1, s1 = s;
+    }
+    return (uint32_t)(s0 < 0 ? s0 + q : s0);
+}
+
+/* Advances k to the next value making every a[j] * k + 1 prime. Windows of
+   FAMILY_WINDOW consecutive k are sieved first: for each small prime q the
+   one class of k with q | a[j] * k + 1 is struck out per factor, so only
+   survivors get a base-2 strong test per factor, and BPSW once all pass. */
+static void family_next(mpz_t k, const unsigned *a, int m, mpz_t f, PRIMALITY_CTX *c) {
+    static uint32_t sp[FAMILY_NPRIMES];
+    static size_t nsp;
+    if (!nsp) nsp = prime_sieve_fill(sp, FAMILY_NPRIMES, 3, FAMILY_LIMIT);
+    uint8_t *mark = malloc(FAMILY_WINDOW);
+
+    for (;; mpz_add_ui(k, k, FAMILY_WINDOW)) {
+        memset(mark, 0, FAMILY_WINDOW);
+        for (size_t i = 0; i < nsp; i++) {
+            uint32_t q = sp[i], r = (uint32_t)mpz_fdiv_ui(k, q);
+            for (int j = 0; j < m; j++) {
+                if (a[j] % q == 0) continue;            // a[j] * k + 1 = 1 mod q
+                // k + t = -1 / a[j] (mod q)
+                uint32_t t = (uint32_t)((2ull * q - inv_mod(a[j], q) - r) % q);
+                for (; t < FAMILY_WINDOW; t += q) mark[t] = 1;
+            }
+        }
+        for (uint32_t t = 0; t < FAMILY_WINDOW; t++) {
+            if (mark[t]) continue;
+            int ok = 1;
+            for (int pass = 0; pass < 2 && ok; pass++)
+                for (int j = 0; j < m && ok; j++) {
+                    mpz_add_ui(f, k, t);
+                    mpz_mul_ui(f, f, a[j]);
+                    mpz_add_ui(f, f, 1);
+                    ok = pass ? bpsw_ctx(f, c) : miller_rabin_base(f, 2, c);
+                }
+            if (ok) {
+                mpz_add_ui(k, k, t);
+                free(mark);
+                return;
+            }
+        }
+    }
+}
+
+/* n = prod (a[j] * k + 1) with k drawn so that n has about `bits` bits;
+   lead = prod a[j], so n ~ lead * k^m */
+static void family_number(mpz_t n, int bits, const unsigned *a, int m, unsigned long lead,
+                          gmp_randstate_t rng, PRIMALITY_CTX *c) {
+    mpz_t k, lo, f;
+    mpz_inits(k, lo, f, NULL);
+    do {
+        // k in [root(2^(bits-1) / lead), 1.125 * that): a top-bit n, rarely one bit over
+        mpz_set_ui(lo, 0);
+        mpz_setbit(lo, (mp_bitcnt_t)bits - 1);
+        mpz_cdiv_q_ui(lo, lo, lead);
+        mpz_root(lo, lo, (unsigned long)m);
+        mpz_add_ui(lo, lo, 1);
+        mpz_fdiv_q_2exp(k, lo, 3);
+        mpz_urandomm(k, rng, k);
+        mpz_add(k, k, lo);
+
+        family_next(k, a, m, f, c);
+        mpz_set_ui(n, 1);
+        for (int j = 0; j < m; j++) {
+            mpz_mul_ui(f, k, a[j]);
+            mpz_add_ui(f, f, 1);
+            mpz_mul(n, n, f);
+        }
+    } while (mpz_sizeinbase(n, 2) != (size_t)bits);
+    mpz_clears(k, lo, f, NULL);
+}
+
+static void corpus_number(mpz_t n, CORPUS corpus, int bits, gmp_randstate_t rng, PRIMALITY_CTX *c) {
+    static const unsigned chernick[] = {6, 12, 18};
+    static const unsigned twin[] = {4, 8};     // p = 4k+1, 2p-1 = 8k+1 (= 1 mod 8: 2 is a QR)
+
+    switch (corpus) {
+    case CORPUS_PRIME:
+        prime_search_random(n, rng, bits, 25);
+        break;
+    case CORPUS_COMPOSITE:
+        do {
+            mpz_urandomb(n, rng, (mp_bitcnt_t)bits);
+            mpz_setbit(n, (mp_bitcnt_t)bits - 1);
+            mpz_setbit(n, 0);
+        } while (mpz_probab_prime_p(n, 25));
+        break;
+    case CORPUS_CARMICHAEL:
+        family_number(n, bits, chernick, 3, 6 * 12 * 18, rng, c);
+        break;
+    default:
+        // p(2p-1) is a base-2 Fermat pseudoprime; keep the strong ones
+        do family_number(n, bits, twin, 2, 4 * 8, rng, c);
+        while (!miller_rabin_base(n, 2, c));
+        break;
+    }
+}
+
+/* Seed for number i of a corpus; mixed (splitmix64) so nearby tuples
+   give unrelated Mersenne Twister states */
+static unsigned long corpus_seed(unsigned long seed, int corpus, int bits, long i) {
+    uint64_t x = seed + 0x9E3779B97F4A7C15ull *
+                 (((uint64_t)corpus << 48) ^ ((uint64_t)bits << 32) ^ (uint64_t)i);
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return (unsigned long)(x ^ (x >> 31));
+}
+
+/* Corpus cache: one "corpus bits hex" line per number */
+static long cache_load(const char *path, int corpus, int bits, mpz_t *out, long max) {
+    FILE *f = fopen(path, "r");
+    if (!f) return 0;
+    char name[32];
+    int b;
+    long n = 0;
+    mpz_t skip;
+    mpz_init(skip);
+    while (n < max && fscanf(f, "%31s %d", name, &b) == 2) {
+        int match = strcmp(name, corpus_name[corpus]) == 0 && b == bits;
+        if (gmp_fscanf(f, " %Zx", match ? out[n] : skip) != 1) break;
+        n += match;
+    }
+    mpz_clear(skip);
+    fclose(f);
+    return n;
+}
+
+static void cache_append(const char *path, int corpus, int bits, const mpz_t n) {
+    FILE *f = fopen(path, "a");
+    if (!f) return;
+    gmp_fprintf(f, "%s %d %Zx\n", corpus_name[corpus], bits, n);
+    fclose(f);
+}
+
+/* ---- Results ---- */
+
+typedef struct {
+    int test, corpus, bits;
+    long numbers;
+    CT_STATS full, round;
+    long errors, trials, liars;
+} RESULT;
+
+static void write_csv(FILE *f, const RESULT *res, int n, int k) {
+    fprintf(f, "test,corpus,bits,numbers,rounds,avg_cycles,numbers_per_sec,round_cycles,"
+               "errors,liar_trials,liars,liar_rate\n");
+    for (int i = 0; i < n; i++) {
+        const RESULT *r = &res[i];
+        double avg = ct_stats_avg(&r->full);
+        fprintf(f, "%s,%s,%d,%ld,%d,%.2f,%.2f,%.2f,%ld,%ld,%ld,%.6f\n", tests[r->test].name,
+                corpus_name[r->corpus], r->bits, r->numbers, k, avg, ct_hz() / avg,
+                ct_stats_avg(&r->round), r->errors, r->trials, r->liars,
+                r->trials ? (double)r->liars / (double)r->trials : 0.0);
+    }
+}
+
+static void write_text(FILE *f, const RESULT *res, int n, int k) {
+    fprintf(f, "%-19s %-10s %5s %5s %14s %12s %13s %6s %14s\n", "test", "corpus", "bits", "n",
+            "cycles", "numbers/s", "round cycles", "errors", "liars/trials");
+    for (int i = 0; i < n; i++) {
+        const RESULT *r = &res[i];
+        double avg = ct_stats_avg(&r->full);
+        char liars[32];
+        snprintf(liars, sizeof liars, "%ld/%ld", r->liars, r->trials);
+        fprintf(f, "%-19s %-10s %5d %5ld %14.0f %12.1f %13.0f %6ld %14s\n", tests[r->test].name,
+                corpus_name[r->corpus], r->bits, r->numbers, avg, ct_hz() / avg,
+                ct_stats_avg(&r->round), r->errors, r->corpus == CORPUS_PRIME ? "-" : liars);
+    }
+    fprintf(f, "(k = %d rounds; round cycles = one single-round call)\n", k);
+}
+
+/* avg_cycles for (test, corpus, bits) in a CSV written by --format csv */
+static int baseline_lookup(FILE *f, const char *test, const char *corpus, int bits, double *avg) {
+    char line[512];
+    rewind(f);
+    while (fgets(line, sizeof line, f)) {
+        char t[64], cp[32];
+        int b, rounds;
+        long nums;
+        double a;
+        if (sscanf(line, "%63[^,],%31[^,],%d,%ld,%d,%lf", t, cp, &b, &nums, &rounds, &a) != 6)
+            continue;   // header or malformed line
+        if (strcmp(t, test) == 0 && strcmp(cp, corpus) == 0 && b == bits) {
+            *avg = a;
+            return 0;
+        }
+    }
+    return -1;
+}
+
+static int compare_baseline(const char *path, double tolerance, const RESULT *res, int n) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        perror(path);
+        return -1;
+    }
+    int regressions = 0;
+    fprintf(stderr, "\nBaseline comparison against %s (tolerance %.1f%%):\n", path, tolerance);
+    for (int i = 0; i < n; i++) {
+        const RESULT *r = &res[i];
+        double base;
+        if (baseline_lookup(f, tests[r->test].name, corpus_name[r->corpus], r->bits, &base) != 0
+            || base <= 0) {
+            fprintf(stderr, "  %-19s %-10s %5d  no baseline\n", tests[r->test].name,
+                    corpus_name[r->corpus], r->bits);
+            continue;
+        }
+        double now = ct_stats_avg(&r->full);
+        double delta = (now - base) * 100.0 / base;
+        int bad = delta > tolerance;
+        regressions += bad;
+        fprintf(stderr, "  %-19s %-10s %5d  %14.2f -> %14.2f cycles  %+7.2f%%  %s\n",
+                tests[r->test].name, corpus_name[r->corpus], r->bits, base, now, delta,
+                bad ? "REGRESSION" : "ok");
+    }
+    fclose(f);
+    return regressions;
+}
+
+/* ---- Main ---- */
+
+static void usage(const char *prog) {
+    fprintf(stderr,
+        "Usage: %s [options]\n"
+        "  --bits LIST       comma-separated sizes (default 64,128,256,512,1024,2048,4096)\n"
+        "  --count N         inputs per corpus at 512 bits, scaled by 512/bits (default 16)\n"
+        "  --rounds K        rounds for Miller-Rabin, Solovay-Strassen, GMP (default 25)\n"
+        "  --trials N        single-round tests per input (default 32)\n"
+        "  --seed S          corpus seed (default fixed)\n"
+        "  --corpus FILE     load corpora from FILE, appending any generated numbers\n"
+        "  --format F        text | csv (default text)\n"
+        "  --out FILE        write results to FILE instead of stdout\n"
+        "  --baseline FILE   compare avg cycles against a CSV from an earlier run\n"
+        "  --tolerance PCT   allowed slowdown vs baseline (default 10)\n", prog);
+}
+
+int main(int argc, char **argv) {
+    int sizes[MAX_SIZES] = {64, 128, 256, 512, 1024, 2048, 4096};
+    int nsizes = 7;
+    long count = 16, trials = 32;
+    int k = 25;
+    unsigned long seed = 0x9B1BE5C;
+    const char *format = "text", *out_path = NULL, *baseline = NULL, *cache = NULL;
+    double tolerance = 10.0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(a, "-h") == 0 || strcmp(a, "--help") == 0) {
+            usage(argv[0]);
+            return 0;
+        }
+        if (!v) { usage(argv[0]); return 1; }
+        if (strcmp(a, "--bits") == 0) {
+            char *copy = strdup(v);
+            nsizes = 0;
+            for (char *tok = strtok(copy, ","); tok && nsizes < MAX_SIZES; tok = strtok(NULL, ","))
+                sizes[nsizes++] = atoi(tok);
+            free(copy);
+        }
+        else if (strcmp(a, "--count") == 0)     count = atol(v);
+        else if (strcmp(a, "--rounds") == 0)    k = atoi(v);
+        else if (strcmp(a, "--trials") == 0)    trials = atol(v);
+        else if (strcmp(a, "--seed") == 0)      seed = strtoul(v, NULL, 0);
+        else if (strcmp(a, "--corpus") == 0)    cache = v;
+        else if (strcmp(a, "--format") == 0)    format = v;
+        else if (strcmp(a, "--out") == 0)       out_path = v;
+        else if (strcmp(a, "--baseline") == 0)  baseline = v;
+        else if (strcmp(a, "--tolerance") == 0) tolerance = atof(v);
+        else { usage(argv[0]); return 1; }
+        i++;
+    }
+    int bad_size = nsizes == 0;
+    for (int s = 0; s < nsizes; s++) bad_size |= sizes[s] < 64 || sizes[s] > 8192;
+    if (bad_size || count < 1 || k < 1 || trials < 0) {
+        fprintf(stderr, "sizes must be 64..8192 bits; count and rounds at least 1\n");
+        return 1;
+    }
+
+    ct_init();
+    gmp_randstate_t corpus_rng, rng;
+    gmp_randinit_mt(corpus_rng);
+    gmp_randinit_mt(rng);
+    gmp_randseed_ui(rng, seed + 1);
+    PRIMALITY_CTX c;
+    primality_ctx_init(&c);
+    u64_dispatch_enabled = 0;
+
+    RESULT *res = calloc((size_t)nsizes * CORPUS_COUNT * NTESTS, sizeof *res);
+    if (!res) return 1;
+    int nres = 0;
+    long wrong = 0;
+
+    for (int s = 0; s < nsizes; s++) {
+        int bits = sizes[s];
+        long nums = count * 512 / bits > 2 ? count * 512 / bits : 2;
+        mpz_t *corpus = malloc((size_t)nums * sizeof *corpus);
+        for (int cp = 0; cp < CORPUS_COUNT; cp++) {
+            fprintf(stderr, "%d-bit %s corpus...\n", bits, corpus_name[cp]);
+            for (long i = 0; i < nums; i++) mpz_init(corpus[i]);
+            long have = cache ? cache_load(cache, cp, bits, corpus, nums) : 0;
+            for (long i = have; i < nums; i++) {
+                gmp_randseed_ui(corpus_rng, corpus_seed(seed, cp, bits, i));
+                corpus_number(corpus[i], (CORPUS)cp, bits, corpus_rng, &c);
+                if (cache) cache_append(cache, cp, bits, corpus[i]);
+            }
+            int expect = cp == CORPUS_PRIME;
+
+            for (int t = 0; t < NTESTS; t++) {
+                RESULT *r = &res[nres++];
+                r->test = t;
+                r->corpus = cp;
+                r->bits = bits;
+                r->numbers = nums;
+                ct_stats_reset(&r->full);
+                ct_stats_reset(&r->round);
+                for (long i = 0; i < nums; i++) {
+                    uint64_t t0 = ct_start();
+                    int v = tests[t].fn(corpus[i], k, rng, &c);
+                    ct_stats_add(&r->full, ct_elapsed(t0, ct_stop()));
+                    r->errors += v != expect;
+
+                    for (long j = 0; j < trials; j++) {
+                        t0 = ct_start();
+                        v = tests[t].fn(corpus[i], 1, rng, &c);
+                        ct_stats_add(&r->round, ct_elapsed(t0, ct_stop()));
+                        if (expect) r->errors += !v;
+                        else r->liars += v;
+                        r->trials++;
+                    }
+                }
+                wrong += r->errors;
+
+                char variant[32];
+                snprintf(variant, sizeof variant, "%s/%s", tests[t].name, corpus_name[cp]);
+                ct_csv_report("prime_bench", variant, (size_t)bits, &r->full, NULL);
+            }
+            for (long i = 0; i < nums; i++) mpz_clear(corpus[i]);
+        }
+        free(corpus);
+    }
+
+    FILE *out = stdout;
+    if (out_path && !(out = fopen(out_path, "w"))) {
+        perror(out_path);
+        free(res);
+        return 1;
+    }
+    if (strcmp(format, "csv") == 0) write_csv(out, res, nres, k);
+    else write_text(out, res, nres, k);
+    if (out != stdout) fclose(out);
+
+    int status = wrong ? 1 : 0;
+    if (wrong) fprintf(stderr, "%ld wrong verdicts\n", wrong);
+    if (baseline) {
+        int reg = compare_baseline(baseline, tolerance, res, nres);
+        if (reg < 0) status = 1;
+        else if (reg > 0 && !status) status = 3;
+    }
+
+    free(res);
+    primality_ctx_clear(&c);
+    gmp_randclear(rng);
+    gmp_randclear(corpus_rng);
+    return status;
+}
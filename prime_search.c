@@ -0,0 +1,127 @@
+// prime_search.c
+// Incremental sieve for prime generation (see prime_search.h).
+
+#include <string.h>
+#include <pthread.h>
+
+#include "prime_search.h"
+#include "prime_sieve.h"
+
+#define PS_LIMIT 17881u         // PS_NPRIMES-th odd prime
+
+static uint32_t small_prime[PS_NPRIMES];
+// Products of consecutive small primes that fit in 64 bits: one mpz_fdiv_ui
+// per group instead of one per prime when a search starts
+static uint64_t group_prod[PS_NPRIMES];
+static int group_first[PS_NPRIMES + 1];
+static int ngroups;
+static pthread_once_t tables_once = PTHREAD_ONCE_INIT;
+
+static void build_tables(void) {
+    prime_sieve_fill(small_prime, PS_NPRIMES, 3, PS_LIMIT + 1);
+
+    ngroups = 0;
+    for (int i = 0; i < PS_NPRIMES; ) {
+        uint64_t prod = 1;
+        group_first[ngroups] = i;
+        while (i < PS_NPRIMES && prod <= UINT64_MAX / small_prime[i]) prod *= small_prime[i++];
+        group_prod[ngroups++] = prod;
+    }
+    group_first[ngroups] = PS_NPRIMES;
+}
+
+const uint32_t *prime_search_small_primes(void) {
+    pthread_once(&tables_once, build_tables);
+    return small_prime;
+}
+
+void prime_search_init(PRIME_SEARCH *ps) {
+    pthread_once(&tables_once, build_tables);
+    mpz_init(ps->base);
+    ps->pos = PS_WINDOW;
+    ps->small = 0;
+}
+
+void prime_search_clear(PRIME_SEARCH *ps) {
+    mpz_clear(ps->base);
+}
+
+/* Mark every window index k with base + 2k divisible by a small prime. */
+static void sieve_window(PRIME_SEARCH *ps) {
+    memset(ps->sieve, 0, sizeof ps->sieve);
+    for (int i = 0; i < PS_NPRIMES; i++) {
+        uint32_t p = small_prime[i];
+        uint32_t r = ps->res[i];
+        // first k with r + 2k == 0 (mod p): k = (p - r) / 2 if p - r is even, else (2p - r) / 2
+        uint32_t k = r == 0 ? 0 : ((p - r) & 1 ? (2 * p - r) / 2 : (p - r) / 2);
+        for (; k < PS_WINDOW; k += p) ps->sieve[k] = 1;
+    }
+    ps->pos = 0;
+}
+
+/* Slide the window forward by PS_WINDOW odd candidates (2 * PS_WINDOW integers). */
+static void advance_window(PRIME_SEARCH *ps) {
+    mpz_add_ui(ps->base, ps->base, 2 * PS_WINDOW);
+    for (int i = 0; i < PS_NPRIMES; i++)
+        ps->res[i] = (ps->res[i] + 2 * PS_WINDOW) % small_prime[i];
+    sieve_window(ps);
+}
+
+void prime_search_start(PRIME_SEARCH *ps, const mpz_t start) {
+    mpz_set(ps->base, start);
+    if (mpz_even_p(ps->base)) mpz_add_ui(ps->base, ps->base, 1);
+
+    // Below PS_LIMIT^2 the sieve would reject the small primes themselves
+    ps->small = mpz_cmp_ui(ps->base, (unsigned long)PS_LIMIT * PS_LIMIT) <= 0;
+    if (ps->small) return;
+
+    for (int g = 0; g < ngroups; g++) {
+        uint64_t r = mpz_fdiv_ui(ps->base, group_prod[g]);
+        for (int i = group_first[g]; i < group_first[g + 1]; i++)
+            ps->res[i] = (uint32_t)(r % small_prime[i]);
+    }
+    sieve_window(ps);
+}
+
+void prime_search_next(PRIME_SEARCH *ps, mpz_t cand) {
+    if (ps->small) {
+        mpz_set(cand, ps->base);
+        mpz_add_ui(ps->base, ps->base, 2);
+        return;
+    }
+    for (;;) {
+        while (ps->pos < PS_WINDOW && ps->sieve[ps->pos]) ps->pos++;
+        if (ps->pos < PS_WINDOW) break;
+        advance_window(ps);
+    }
+    mpz_add_ui(cand, ps->base, 2 * (unsigned long)ps->pos);
+    ps->pos++;
+}
+
+int prime_search_find(PRIME_SEARCH *ps, mpz_t prime, int reps, int max_bits,
+                      const atomic_int *cancel) {
+    if (ps->small) {
+        mpz_sub_ui(prime, ps->base, 1);
+        mpz_nextprime(prime, prime);
+        mpz_add_ui(ps->base, prime, 2);
+        return max_bits == 0 || mpz_sizeinbase(prime, 2) <= (size_t)max_bits;
+    }
+    for (;;) {
+        if (cancel && atomic_load_explicit(cancel, memory_order_relaxed)) return 0;
+        prime_search_next(ps, prime);
+        if (max_bits && mpz_sizeinbase(prime, 2) > (size_t)max_bits) return 0;
+        // survivors have no factor below PS_LIMIT, so skip GMP's own trial division
+        if (mpz_millerrabin(prime, reps)) return 1;
+    }
+}
+
+void prime_search_random(mpz_t prime, gmp_randstate_t state, int bits, int reps) {
+    PRIME_SEARCH ps;
+    prime_search_init(&ps);
+    do {
+        mpz_urandomb(prime, state, bits);
+        mpz_setbit(prime, bits - 1);
+        prime_search_start(&ps, prime);
+    } while (!prime_search_find(&ps, prime, reps, bits, NULL));
+    prime_search_clear(&ps);
+}
@@ -0,0 +1,50 @@
+// prime_search.h
+// Sieve-accelerated incremental prime search.
+//
+// prime_search_start() reduces the starting candidate modulo the first
+// PS_NPRIMES odd primes once. The search then sieves a window of PS_WINDOW
+// odd candidates with those residues (word arithmetic only) and hands just
+// the survivors to one Miller-Rabin/BPSW pass. Moving to the next window
+// updates each residue with a single add-and-reduce instead of touching the
+// big number again.
+
+#ifndef PRIME_SEARCH_H
+#define PRIME_SEARCH_H
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <gmp.h>
+
+#define PS_NPRIMES 2048     // odd primes 3 .. 17881
+#define PS_WINDOW  2048     // odd candidates sieved per window (covers 4096 integers)
+
+typedef struct {
+    mpz_t base;                 // odd candidate at window index 0
+    uint32_t res[PS_NPRIMES];   // base mod small_prime[i]
+    uint8_t sieve[PS_WINDOW];   // 1 = divisible by a small prime
+    int pos;                    // next window index to examine
+    int small;                  // start below the sieve limit: fall back to mpz_nextprime
+} PRIME_SEARCH;
+
+void prime_search_init(PRIME_SEARCH *ps);
+void prime_search_clear(PRIME_SEARCH *ps);
+
+// Position the search at the first odd number >= start
+void prime_search_start(PRIME_SEARCH *ps, const mpz_t start);
+
+// Next candidate with no factor among the small primes
+void prime_search_next(PRIME_SEARCH *ps, mpz_t cand);
+
+// Next probable prime (reps Miller-Rabin rounds after BPSW); returns 1 when
+// found, 0 when the candidate grew past max_bits (0 = no limit) or *cancel
+// was raised (cancel may be NULL)
+int prime_search_find(PRIME_SEARCH *ps, mpz_t prime, int reps, int max_bits,
+                      const atomic_int *cancel);
+
+// Random prime of exactly `bits` bits (bits >= 3)
+void prime_search_random(mpz_t prime, gmp_randstate_t state, int bits, int reps);
+
+// The odd primes used by the sieve, ascending (small_prime[0] == 3)
+const uint32_t *prime_search_small_primes(void);
+
+#endif /* PRIME_SEARCH_H */
@@ -0,0 +1,309 @@
+/*
+Segmented wheel-30 prime sieve (see prime_sieve.h) plus a benchmark.
+
+To compile:
+    make prime_sieve
+
+To run:
+    ./build/bin/prime_sieve [limit=1000000000] [max_threads]
+
+Counts the primes below limit with 1, 2, 4, ... max_threads threads and
+prints time and primes per second for each; checks pi(10^k) for every power
+of ten up to limit, that all thread counts agree, and the primes of the last
+window below limit against mpz_probab_prime_p. Exits non-zero on a mismatch.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <gmp.h>
+
+#include "prime_sieve.h"
+#include "cycle_timer.h"
+
+#define PSV_SPAN    (30ull * PSV_SEG_BYTES)     // integers per segment
+#define PSV_PATTERN 1001                        // 7 * 11 * 13 bytes
+#define PSV_FIRST   17u                         // first prime sieved by striding
+
+static const uint8_t wheel[8] = {1, 7, 11, 13, 17, 19, 23, 29};
+static int8_t wheel_bit[30];                    // residue -> bit, -1 if not coprime to 30
+static uint8_t pattern[PSV_PATTERN];            // multiples of 7, 11, 13 from 0
+static pthread_once_t tables_once = PTHREAD_ONCE_INIT;
+
+static void build_tables(void) {
+    memset(wheel_bit, -1, sizeof wheel_bit);
+    for (int i = 0; i < 8; i++) wheel_bit[wheel[i]] = (int8_t)i;
+    static const uint32_t pre[] = {7, 11, 13};
+    for (int k = 0; k < 3; k++)
+        for (uint32_t n = pre[k]; n < 30 * PSV_PATTERN; n += 2 * pre[k])
+            if (wheel_bit[n % 30] >= 0) pattern[n / 30] |= (uint8_t)(1u << wheel_bit[n % 30]);
+}
+
+typedef struct {
+    uint64_t lo, hi;                // requested range
+    uint64_t base;                  // lo rounded down to a multiple of 30
+    uint64_t nblocks;
+    const uint32_t *prime;          // sieving primes PSV_FIRST .. sqrt(hi)
+    size_t nprimes;
+    PRIME_SIEVE_FN fn;
+    void *arg;
+    atomic_ullong next_block;
+    atomic_llong count;
+    atomic_int failed;
+} PSV_SHARED;
+
+/* First multiple p * m >= start with m >= p and m = wheel[i] (mod 30), as a
+   byte offset from seg_lo (a multiple of 30) */
+static uint64_t psv_first(uint32_t p, int i, uint64_t seg_lo) {
+    uint64_t m = (seg_lo + p - 1) / p;
+    if (m < p) m = p;
+    m += (wheel[i] + 30 - m % 30) % 30;
+    return (p * m - seg_lo) / 30;
+}
+
+/* Sieve bytes [0, nbytes) of the segment at seg_lo with the stride state off */
+static void psv_segment(const PSV_SHARED *sh, uint8_t *seg, size_t nbytes, uint64_t seg_lo,
+                        uint64_t *off) {
+    // pattern for 7, 11, 13, then the striding primes
+    size_t pos = (size_t)((seg_lo / 30) % PSV_PATTERN);
+    for (size_t b = 0; b < nbytes; ) {
+        size_t len = PSV_PATTERN - pos < nbytes - b ? PSV_PATTERN - pos : nbytes - b;
+        memcpy(seg + b, pattern + pos, len);
+        b += len;
+        pos = 0;
+    }
+    if (seg_lo == 0) seg[0] = (uint8_t)((seg[0] & ~0x0e) | 0x01);   // 7 11 13 prime, 1 not
+
+    for (size_t k = 0; k < sh->nprimes; k++) {
+        uint32_t p = sh->prime[k];
+        uint64_t *o = off + 8 * k;
+        for (int i = 0; i < 8; i++) {
+            uint8_t mask = (uint8_t)(1u << wheel_bit[(uint64_t)p * wheel[i] % 30]);
+            uint64_t b = o[i];
+            for (; b < nbytes; b += p) seg[b] |= mask;
+            o[i] = b - nbytes;
+        }
+    }
+
+    // out-of-range residues in the first and last byte count as composite
+    for (int i = 0; i < 8; i++) {
+        if (seg_lo + wheel[i] < sh->lo) seg[0] |= (uint8_t)(1u << i);
+        if (seg_lo + 30 * (nbytes - 1) + wheel[i] >= sh->hi) seg[nbytes - 1] |= (uint8_t)(1u << i);
+    }
+}
+
+static size_t psv_collect(const uint8_t *seg, size_t nbytes, uint64_t seg_lo, uint64_t *out) {
+    size_t n = 0;
+    for (size_t b = 0; b < nbytes; b++) {
+        unsigned bits = (uint8_t)~seg[b];
+        while (bits) {
+            out[n++] = seg_lo + 30 * b + wheel[__builtin_ctz(bits)];
+            bits &= bits - 1;
+        }
+    }
+    return n;
+}
+
+static uint64_t psv_count(const uint8_t *seg, size_t nbytes) {
+    uint64_t n = 0;
+    size_t b = 0;
+    for (; b + 8 <= nbytes; b += 8) {
+        uint64_t w;
+        memcpy(&w, seg + b, 8);
+        n += (uint64_t)__builtin_popcountll(~w);
+    }
+    for (; b < nbytes; b++) n += (uint64_t)__builtin_popcount((uint8_t)~seg[b]);
+    return n;
+}
+
+static void *psv_worker(void *arg) {
+    PSV_SHARED *sh = arg;
+    uint8_t *seg = malloc(PSV_SEG_BYTES);
+    uint64_t *off = malloc((sh->nprimes ? sh->nprimes : 1) * 8 * sizeof *off);
+    uint64_t *out = sh->fn ? malloc(8 * PSV_SEG_BYTES * sizeof *out) : NULL;
+    if (!seg || !off || (sh->fn && !out)) {
+        atomic_store(&sh->failed, 1);
+        goto done;
+    }
+
+    int64_t count = 0;
+    for (;;) {
+        uint64_t blk = atomic_fetch_add(&sh->next_block, 1);
+        if (blk >= sh->nblocks) break;
+        uint64_t seg_lo = sh->base + blk * PSV_BLOCK * PSV_SPAN;
+        for (size_t k = 0; k < sh->nprimes; k++)
+            for (int i = 0; i < 8; i++) off[8 * k + i] = psv_first(sh->prime[k], i, seg_lo);
+
+        for (int s = 0; s < PSV_BLOCK && seg_lo < sh->hi; s++, seg_lo += PSV_SPAN) {
+            uint64_t left = (sh->hi - seg_lo + 29) / 30;
+            size_t nbytes = left < PSV_SEG_BYTES ? (size_t)left : PSV_SEG_BYTES;
+            psv_segment(sh, seg, nbytes, seg_lo, off);
+            if (sh->fn) {
+                size_t n = psv_collect(seg, nbytes, seg_lo, out);
+                if (n) sh->fn(out, n, sh->arg);
+                count += (int64_t)n;
+            } else {
+                count += (int64_t)psv_count(seg, nbytes);
+            }
+        }
+    }
+    atomic_fetch_add(&sh->count, count);
+
+done:
+    free(out);
+    free(off);
+    free(seg);
+    return NULL;
+}
+
+int64_t prime_sieve(uint64_t lo, uint64_t hi, int threads, PRIME_SIEVE_FN fn, void *arg) {
+    if (hi > PSV_MAX) return -1;
+    if (lo >= hi) return 0;
+    pthread_once(&tables_once, build_tables);
+
+    // 2 3 5 are off the wheel, 7 11 13 come from the pattern
+    static const uint64_t head[] = {2, 3, 5};
+    uint64_t small[3];
+    size_t nsmall = 0;
+    for (int i = 0; i < 3; i++)
+        if (head[i] >= lo && head[i] < hi) small[nsmall++] = head[i];
+    if (fn && nsmall) fn(small, nsmall, arg);
+    if (hi <= 7) return (int64_t)nsmall;
+    if (lo < 7) lo = 7;
+
+    // sieving primes below sqrt(hi) from a plain odd-only sieve (< 2^21)
+    uint32_t root = 1;
+    while ((uint64_t)(root + 1) * (root + 1) < hi) root++;
+    uint8_t *comp = calloc(root / 2 + 1, 1);
+    uint32_t *prime = malloc((root / 2 + 1) * sizeof *prime);
+    if (!comp || !prime) {
+        free(comp);
+        free(prime);
+        return -1;
+    }
+    size_t np = 0;
+    for (uint32_t i = 3; i <= root; i += 2) {
+        if (comp[i / 2]) continue;
+        if (i >= PSV_FIRST) prime[np++] = i;
+        for (uint64_t j = (uint64_t)i * i; j <= root; j += 2 * i) comp[j / 2] = 1;
+    }
+    free(comp);
+
+    PSV_SHARED sh;
+    sh.lo = lo;
+    sh.hi = hi;
+    sh.base = lo - lo % 30;
+    sh.nblocks = (hi - sh.base + PSV_BLOCK * PSV_SPAN - 1) / (PSV_BLOCK * PSV_SPAN);
+    sh.prime = prime;
+    sh.nprimes = np;
+    sh.fn = fn;
+    sh.arg = arg;
+    atomic_init(&sh.next_block, 0);
+    atomic_init(&sh.count, (long long)nsmall);
+    atomic_init(&sh.failed, 0);
+
+    if (threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (threads <= 0) threads = 1;
+    if ((uint64_t)threads > sh.nblocks) threads = (int)sh.nblocks;
+
+    pthread_t *tid = malloc((size_t)threads * sizeof *tid);
+    int started = 0;
+    if (tid)
+        for (; started < threads - 1; started++)
+            if (pthread_create(&tid[started], NULL, psv_worker, &sh) != 0) break;
+    psv_worker(&sh);        // the caller works too
+    for (int t = 0; t < started; t++) pthread_join(tid[t], NULL);
+    free(tid);
+    free(prime);
+    return atomic_load(&sh.failed) ? -1 : (int64_t)atomic_load(&sh.count);
+}
+
+typedef struct {
+    uint32_t *out;
+    size_t max, n;
+} PSV_FILL;
+
+static void psv_fill(const uint64_t *primes, size_t count, void *arg) {
+    PSV_FILL *f = arg;
+    for (size_t i = 0; i < count && f->n < f->max; i++) f->out[f->n++] = (uint32_t)primes[i];
+}
+
+size_t prime_sieve_fill(uint32_t *out, size_t max, uint32_t lo, uint32_t hi) {
+    PSV_FILL f = {out, max, 0};
+    prime_sieve(lo, hi, 1, psv_fill, &f);
+    return f.n;
+}
+
+/* ---- Benchmark: prime counts below a limit, by thread count ---- */
+
+#ifndef CRYPTO_NO_MAIN
+typedef struct {
+    uint64_t *p;
+    size_t n, cap;
+} WINDOW;
+
+static void window_add(const uint64_t *primes, size_t count, void *arg) {
+    WINDOW *w = arg;
+    for (size_t i = 0; i < count && w->n < w->cap; i++) w->p[w->n++] = primes[i];
+}
+
+int main(int argc, char **argv) {
+    uint64_t limit = argc > 1 ? strtoull(argv[1], NULL, 0) : 1000000000ull;
+    int max_thr = argc > 2 ? atoi(argv[2]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (limit < 2 || limit > PSV_MAX || max_thr < 1) {
+        fprintf(stderr, "Usage: %s [limit <= 2^42] [max_threads]\n", argv[0]);
+        return 1;
+    }
+
+    ct_init();
+    int failed = 0;
+
+    // pi(10^k), k = 1..12
+    static const int64_t pi10[] = {4, 25, 168, 1229, 9592, 78498, 664579, 5761455,
+                                   50847534, 455052511, 4118054813ll, 37607912018ll};
+    uint64_t p10 = 10;
+    for (int k = 0; k < 12 && p10 <= limit; k++, p10 *= 10)
+        failed |= prime_sieve(0, p10 + 1, 1, NULL, NULL) != pi10[k];
+
+    printf("%-8s %14s %12s %14s\n", "threads", "primes", "seconds", "primes/s");
+    int64_t first = -1;
+    for (int t = 1; t <= max_thr; t *= 2) {
+        uint64_t t0 = ct_start();
+        int64_t n = prime_sieve(0, limit, t, NULL, NULL);
+        double sec = (double)ct_elapsed(t0, ct_stop()) / ct_hz();
+        if (first < 0) first = n;
+        failed |= n != first;
+        printf("%-8d %14lld %12.3f %14.3e\n", t, (long long)n, sec, (double)n / sec);
+
+        CT_STATS st;
+        ct_stats_reset(&st);
+        ct_stats_add(&st, (uint64_t)(sec * ct_hz()));
+        char label[32];
+        snprintf(label, sizeof label, "count_t%d", t);
+        ct_csv_report("prime_sieve", label, (size_t)limit, &st, NULL);
+    }
+
+    // the last window below limit, prime by prime
+    uint64_t wlo = limit > 100000 ? limit - 100000 : 0;
+    WINDOW w = {malloc(100000 * sizeof(uint64_t)), 0, 100000};
+    failed |= prime_sieve(wlo, limit, 1, window_add, &w) != (int64_t)w.n;
+    mpz_t n;
+    mpz_init(n);
+    size_t j = 0;
+    for (uint64_t v = wlo; v < limit; v++) {
+        mpz_set_ui(n, v);
+        int is_prime = mpz_probab_prime_p(n, 25) != 0;
+        int listed = j < w.n && w.p[j] == v;
+        failed |= is_prime != listed;
+        j += (size_t)listed;
+    }
+    mpz_clear(n);
+    free(w.p);
+
+    printf("Result: %s\n", failed ? "MISMATCH" : "all counts match");
+    return failed;
+}
+#endif /* CRYPTO_NO_MAIN */
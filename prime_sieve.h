@@ -0,0 +1,37 @@
+// prime_sieve.h
+// Segmented Sieve of Eratosthenes for enumerating primes in bulk.
+//
+// Numbers are stored on a mod-30 wheel: one byte covers 30 integers, one bit
+// for each residue coprime to 30 (1 7 11 13 17 19 23 29), so multiples of
+// 2, 3 and 5 take no space. The range is sieved in PSV_SEG_BYTES segments
+// that fit in L1; each sieving prime p crosses off its multiples in eight
+// strides of p bytes, one per wheel residue, with a fixed bit per stride.
+// Multiples of 7, 11 and 13 come from a pre-sieved 1001-byte pattern copied
+// in at the start of each segment. Worker threads take blocks of PSV_BLOCK
+// segments from a shared counter and keep their stride offsets from one
+// segment to the next.
+
+#ifndef PRIME_SIEVE_H
+#define PRIME_SIEVE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define PSV_SEG_BYTES 32768             // one segment = 983040 integers
+#define PSV_BLOCK     64                // segments per unit of thread work
+#define PSV_MAX       (1ull << 42)      // upper bound on hi (sieving primes < 2^21)
+
+// Receives the primes of one segment, ascending. With several threads the
+// calls come concurrently and in no particular order between segments.
+typedef void (*PRIME_SIEVE_FN)(const uint64_t *primes, size_t count, void *arg);
+
+// Number of primes in [lo, hi), passing them to fn (may be NULL to only
+// count). threads <= 0 uses one per online CPU; with one thread fn sees the
+// primes in ascending order. Returns -1 if hi > PSV_MAX or allocation fails.
+int64_t prime_sieve(uint64_t lo, uint64_t hi, int threads, PRIME_SIEVE_FN fn, void *arg);
+
+// Fills out with the primes in [lo, hi), ascending, at most max of them;
+// returns how many were stored. Single-threaded, for small-prime tables.
+size_t prime_sieve_fill(uint32_t *out, size_t max, uint32_t lo, uint32_t hi);
+
+#endif /* PRIME_SIEVE_H */
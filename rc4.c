@@ -0,0 +1,322 @@
+// rc4.c with inlining
+// Fully-working, highly-optimized RC4 in C (KSA + PRGA)
+// Uses only unsigned char so all arithmetic is mod 256 for free
+
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "rc4.h"
+#include "cycle_timer.h"   // fenced, calibrated cycle counter (portable fallback inside)
+
+#define RC4_CHUNK  (1u << 20)   // 1 MiB per streaming chunk
+#define RC4_ALIGN  4096         // page-aligned buffers for read()/write()
+
+/**
+ * rc4_init(ctx, key, keylen) KSA ROUND
+ *   Perform RC4 Key-Scheduling Algorithm (KSA):
+ *   - Initialize S to [0,1,2...255]
+ *   - Mix in the key with wraparound via 8-bit adds (no modulus ops)
+ */
+void rc4_init(RC4_CTX *ctx, const u8 *key, size_t keylen) {
+    for (int idx = 0; idx < 256; idx++) {
+        ctx->S[idx] = (u8)idx;
+    }
+    u8 j = 0;
+    for (int idx = 0; idx < 256; idx++) {
+        j = (u8)(j + ctx->S[idx] + key[idx % keylen]);
+        // swap S[idx] <- S[j]
+        u8 tmp      = ctx->S[idx];
+        ctx->S[idx] = ctx->S[j];
+        ctx->S[j]   = tmp;
+    }
+    ctx->i = 0;
+    ctx->j = 0;
+}
+
+/**
+ * rc4_byte(ctx)
+ *   Perform one PRGA step:
+ *     i <- i + 1                // 1 ADD
+ *     j <- j + S[i]             // 1 LOAD, 1 ADD
+ *     swap S[i] and S[j]        // 2 LOAD, 2 STORE
+ *     K <- S[S[i] + S[j]]       // 1 ADD, 1 LOAD (tmp is the old S[i], now in S[j])
+ *   Keystream uses XOR:          // 1 LOAD, 1 XOR, 1 STORE (in rc4_crypt)
+ *   Total per byte: 2 ADD, 3 LOAD, 2 STORE, 1 XOR
+ *
+ * Instruction breakdown (x86_64 estimate):
+ *   inc    %al                  ; 1 cycle
+ *   mov    al, S[i]             ; 2 cycles
+ *   add    bl, al               ; 1 cycle
+ *   mov    bl, S[j]             ; 2 cycles
+ *   xchg   S[i], S[j]           ; 1 cycle
+ *   lea    rdx, [tmp + S[i]]    ; 1 cycle
+ *   mov    al, [S+rdx]          ; 2 cycles
+ * ~10–12 cycles core + memory latency ≈18–22 cycles/byte
+ *
+ * Marked always_inline to ensure compiler inlines it.
+ */
+static inline __attribute__((always_inline)) u8 rc4_byte(RC4_CTX *ctx) {
+    u8 i = (u8)(ctx->i + 1);
+    ctx->i = i;
+
+    u8 j = (u8)(ctx->j + ctx->S[i]);
+    ctx->j = j;
+
+    u8 tmp    = ctx->S[i];
+    ctx->S[i] = ctx->S[j];
+    ctx->S[j] = tmp;
+
+    return ctx->S[(u8)(tmp + ctx->S[i])];
+}
+
+/**
+ * rc4_crypt(ctx, data, datalen) PRGA ROUND
+ *   XOR-encrypt/decrypt data in place using rc4_byte for each byte.
+ *   Measures cycles with ct_start()/ct_stop() (fence overhead subtracted).
+ */
+unsigned long long rc4_crypt(RC4_CTX *ctx, u8 *data, size_t datalen) {
+    uint64_t start = ct_start();
+    for (size_t k = 0; k < datalen; k++) {
+        data[k] ^= rc4_byte(ctx);
+    }
+    uint64_t end = ct_stop();
+    return ct_elapsed(start, end);
+}
+
+#ifndef CRYPTO_NO_MAIN
+/* ---------- Streaming mode (files / stdin) ---------- */
+
+// Two page-aligned chunk buffers shared between the reader thread and the
+// PRGA loop: while rc4_crypt() works on one, read() fills the other.
+typedef struct {
+    u8 *buf[2];
+    size_t len[2];
+    int full[2];
+    int err;                    // errno of a failed read, 0 otherwise
+    int fd;
+    pthread_mutex_t mu;
+    pthread_cond_t cv;
+} RC4_STREAM;
+
+// read() until the buffer is full or EOF, so short pipe reads don't shrink chunks
+static ssize_t read_full(int fd, u8 *buf, size_t cap) {
+    size_t got = 0;
+    while (got < cap) {
+        ssize_t r = read(fd, buf + got, cap - got);
+        if (r == 0) break;
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        got += (size_t)r;
+    }
+    return (ssize_t)got;
+}
+
+static int write_full(int fd, const u8 *buf, size_t len) {
+    while (len > 0) {
+        ssize_t w = write(fd, buf, len);
+        if (w < 0) {
+            if (errno == EINTR) continue;
+            return -1;
+        }
+        buf += w;
+        len -= (size_t)w;
+    }
+    return 0;
+}
+
+// Reader thread: fills buf[0], buf[1], buf[0], ... ; a zero-length chunk marks EOF
+static void *rc4_reader(void *arg) {
+    RC4_STREAM *st = (RC4_STREAM*)arg;
+    for (int idx = 0;; idx ^= 1) {
+        pthread_mutex_lock(&st->mu);
+        while (st->full[idx]) pthread_cond_wait(&st->cv, &st->mu);
+        pthread_mutex_unlock(&st->mu);
+
+        ssize_t n = read_full(st->fd, st->buf[idx], RC4_CHUNK);
+
+        pthread_mutex_lock(&st->mu);
+        if (n < 0) { st->err = errno; n = 0; }
+        st->len[idx]  = (size_t)n;
+        st->full[idx] = 1;
+        pthread_cond_signal(&st->cv);
+        pthread_mutex_unlock(&st->mu);
+        if (n == 0) return NULL;
+    }
+}
+
+/**
+ * rc4_stream_mmap(ctx, in, size, out_fd, cycles)
+ *   Regular files: map the whole input privately and encrypt it in place,
+ *   one chunk at a time, so there is no read() copy at all.
+ */
+static int rc4_stream_mmap(RC4_CTX *ctx, int in_fd, size_t size, int out_fd,
+                           unsigned long long *cycles) {
+    u8 *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, in_fd, 0);
+    if (map == MAP_FAILED) return -1;
+    madvise(map, size, MADV_SEQUENTIAL);
+
+    int rc = 0;
+    for (size_t off = 0; off < size; off += RC4_CHUNK) {
+        size_t n = size - off < RC4_CHUNK ? size - off : RC4_CHUNK;
+        *cycles += rc4_crypt(ctx, map + off, n);
+        if (write_full(out_fd, map + off, n) != 0) { rc = -1; break; }
+    }
+    munmap(map, size);
+    return rc;
+}
+
+/**
+ * rc4_stream_pipe(ctx, in_fd, out_fd, cycles, total)
+ *   Pipes / stdin / anything not mappable: double-buffered read() against
+ *   rc4_crypt() using the reader thread above.
+ */
+static int rc4_stream_pipe(RC4_CTX *ctx, int in_fd, int out_fd,
+                           unsigned long long *cycles, size_t *total) {
+    RC4_STREAM st = { .fd = in_fd };
+    pthread_mutex_init(&st.mu, NULL);
+    pthread_cond_init(&st.cv, NULL);
+    for (int b = 0; b < 2; b++) {
+        if (posix_memalign((void**)&st.buf[b], RC4_ALIGN, RC4_CHUNK) != 0) {
+            free(st.buf[0]);
+            return -1;
+        }
+    }
+
+    pthread_t tid;
+    if (pthread_create(&tid, NULL, rc4_reader, &st) != 0) {
+        free(st.buf[0]); free(st.buf[1]);
+        return -1;
+    }
+
+    int rc = 0;
+    for (int idx = 0;; idx ^= 1) {
+        pthread_mutex_lock(&st.mu);
+        while (!st.full[idx]) pthread_cond_wait(&st.cv, &st.mu);
+        size_t n = st.len[idx];
+        pthread_mutex_unlock(&st.mu);
+        if (n == 0) break;
+
+        *cycles += rc4_crypt(ctx, st.buf[idx], n);
+        *total  += n;
+        if (rc == 0 && write_full(out_fd, st.buf[idx], n) != 0) rc = -1;
+
+        pthread_mutex_lock(&st.mu);
+        st.full[idx] = 0;
+        pthread_cond_signal(&st.cv);
+        pthread_mutex_unlock(&st.mu);
+    }
+
+    pthread_join(tid, NULL);
+    if (st.err) { errno = st.err; rc = -1; }
+    pthread_mutex_destroy(&st.mu);
+    pthread_cond_destroy(&st.cv);
+    free(st.buf[0]);
+    free(st.buf[1]);
+    return rc;
+}
+
+/**
+ * rc4_stream(key, in_path, out_path)
+ *   Encrypt/decrypt binary data from a file or stdin ("-") to a file or
+ *   stdout ("-"). Throughput goes to stderr so stdout stays pure ciphertext.
+ */
+static int rc4_stream(const char *key, const char *in_path, const char *out_path) {
+    if (key[0] == '\0') { fprintf(stderr, "rc4: key must not be empty\n"); return 1; }
+    int in_fd  = strcmp(in_path, "-") == 0 ? STDIN_FILENO : open(in_path, O_RDONLY);
+    if (in_fd < 0) { perror(in_path); return 1; }
+    int out_fd = strcmp(out_path, "-") == 0 ? STDOUT_FILENO
+               : open(out_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (out_fd < 0) {
+        perror(out_path);
+        if (in_fd != STDIN_FILENO) close(in_fd);
+        return 1;
+    }
+
+    ct_init();
+    RC4_CTX ctx;
+    rc4_init(&ctx, (const u8*)key, strlen(key));
+
+    unsigned long long cycles = 0;
+    size_t total = 0;
+    int rc;
+    struct stat sb;
+    uint64_t t0 = ct_start();
+    if (fstat(in_fd, &sb) == 0 && S_ISREG(sb.st_mode) && sb.st_size > 0) {
+        total = (size_t)sb.st_size;
+        rc = rc4_stream_mmap(&ctx, in_fd, total, out_fd, &cycles);
+    } else {
+        rc = rc4_stream_pipe(&ctx, in_fd, out_fd, &cycles, &total);
+    }
+    double elapsed = ct_to_ns((double)ct_elapsed(t0, ct_stop())) * 1e-9;
+
+    if (rc != 0) perror("rc4 stream");
+    if (in_fd != STDIN_FILENO) close(in_fd);
+    if (out_fd != STDOUT_FILENO) close(out_fd);
+
+    double mb = (double)total / (1024.0 * 1024.0);
+    fprintf(stderr, "Processed: %zu bytes in %.3f s (%.2f MB/s sustained)\n",
+            total, elapsed, elapsed > 0 ? mb / elapsed : 0.0);
+    fprintf(stderr, "PRGA cycles: %llu (≈ %.2f cycles/byte)\n",
+            cycles, total ? (double)cycles / (double)total : 0.0);
+
+    CT_STATS stats;
+    ct_stats_reset(&stats);
+    ct_stats_add(&stats, cycles);
+    ct_csv_report("rc4", "stream", total, &stats, NULL);
+    return rc != 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc >= 3 && strcmp(argv[1], "-s") == 0) {
+        return rc4_stream(argv[2], argc > 3 ? argv[3] : "-", argc > 4 ? argv[4] : "-");
+    }
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <key> <plaintext>\n", argv[0]);
+        fprintf(stderr, "       %s -s <key> [infile|-] [outfile|-]\n", argv[0]);
+        return 1;
+    }
+
+    const u8 *key = (const u8*)argv[1];
+    size_t keylen = strlen(argv[1]);
+    u8 *data      = (u8*)malloc(strlen(argv[2]) + 1);
+    strcpy((char*)data, argv[2]);
+    size_t datalen = strlen((char*)data);
+
+    ct_init();
+    RC4_CTX ctx;
+    rc4_init(&ctx, key, keylen);
+
+    unsigned long long cycles = rc4_crypt(&ctx, data, datalen);
+
+    printf("Ciphertext: ");
+    for (size_t i = 0; i < datalen; i++) {
+        printf("%02X", data[i]);
+    }
+    printf("\n");
+
+    printf("PRGA cycles: %llu (≈ %.2f cycles/byte)\n",
+           cycles, (double)cycles / (double)datalen);
+
+    CT_STATS stats;
+    ct_stats_reset(&stats);
+    ct_stats_add(&stats, cycles);
+    ct_csv_report("rc4", "prga", datalen, &stats, NULL);
+
+    free(data);
+    return 0;
+
+    //compile with this command: $make rc4   (or by hand: $gcc -O3 -march=native -std=gnu11 -pthread -o rc4 rc4.c cycle_timer.c)
+    //usage: $./build/bin/rc4 <key> <message>
+    //streaming: $./build/bin/rc4 -s <key> [infile|-] [outfile|-]   (binary-safe, reports MB/s on stderr)
+}
+#endif /* CRYPTO_NO_MAIN */
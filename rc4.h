@@ -0,0 +1,22 @@
+// rc4.h
+// RC4 stream cipher (rc4.c): KSA + PRGA.
+
+#ifndef RC4_H
+#define RC4_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef uint8_t u8;
+
+// RC4 context: 256-byte state array plus two 8-bit indices
+typedef struct {
+    u8 S[256];
+    u8 i, j;
+} RC4_CTX;
+
+void rc4_init(RC4_CTX *ctx, const u8 *key, size_t keylen);
+/* XORs the keystream into data in place; returns the cycles it took */
+unsigned long long rc4_crypt(RC4_CTX *ctx, u8 *data, size_t datalen);
+
+#endif /* RC4_H */
@@ -0,0 +1,382 @@
+/*
+RSA assignment: key generation, encryption and decryption timing for one or
+more prime sizes in a single process (replaces rsa_assignment_512/768/1024.c).
+
+To compile:
+    make rsa_assignment
+
+To run:
+    ./build/bin/rsa_assignment                      512, 768 and 1024-bit primes
+    ./build/bin/rsa_assignment 2048                 one size (512 .. 4096)
+    ./build/bin/rsa_assignment -n 1000 sweep        every size in SWEEP_SIZES
+    ./build/bin/rsa_assignment -n 1000 512 1024
+    ./build/bin/rsa_assignment -k keys.bin 2048     reuse a stored 2048-bit key
+
+-n sets the number of prime pairs generated per size (default ITERATIONS).
+-k names a key store (rsa_keystore.h): a size with a stored key skips prime
+generation and decrypts with the memory-mapped key as is; otherwise the
+generated key is appended to the store for the next run.
+The RNG, the key-generation threads and every GMP integer are set up once
+and reused across sizes; a summary table follows when more than one size runs.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "cycle_timer.h"    // Shared calibrated cycle counter
+#include "rsa_key.h"        // CRT private key (dP, dQ, qInv)
+#include "rsa_keygen.h"     // Multithreaded p/q search
+#include "rsa_keystore.h"   // Memory-mapped keys from earlier runs
+#include <gmp.h>            // GMP big integers
+#include <string.h>
+
+#define ITERATIONS 1000000    // Use 1000000 for final submission
+#define BAR_WIDTH 50        // Width of progress bar
+#define DECRYPT_REPS 200    // Repetitions for the plain vs CRT vs constant-time decryption comparison
+#define MIN_BITS 512
+#define MAX_BITS 4096       // largest prime size; integers are pre-sized for it
+
+static const int SWEEP_SIZES[] = {512, 768, 1024, 1536, 2048, 3072, 4096};
+static const int DEFAULT_SIZES[] = {512, 768, 1024};
+
+// State shared by every size: allocated once, reused by each rsa_test call
+typedef struct {
+    gmp_randstate_t state;
+    RSA_KEYGEN *keygen;
+    RSA_KEYSTORE *store;        // NULL without -k or before the file exists
+    const char *store_path;
+    RSA_KEY key;
+    mpz_t p, q, N, phi, e, d, m, c, m_prime;
+    mpz_t p1, q1, m_crt, m_ct;
+} RSA_CTX;
+
+// Per-size averages for the sweep summary
+typedef struct {
+    int bits;
+    double prime_pair, encrypt, decrypt, decrypt_crt, decrypt_ct;
+    int ok;
+} RSA_RESULT;
+
+// Progress bar
+void print_progress_bar(int current, int total) {
+    float progress = (float)current / total;
+    int pos = (int)(BAR_WIDTH * progress);
+    printf("[");
+    for (int i = 0; i < BAR_WIDTH; ++i) {
+        if (i < pos) printf("=");
+        else if (i == pos) printf(">");
+        else printf(" ");
+    }
+    printf("] %3d%%\r", (int)(progress * 100));
+    fflush(stdout);
+}
+
+static int rsa_ctx_init(RSA_CTX *ctx, const char *store_path) {
+    // Initialize GMP random state (Mersenne Twister)
+    gmp_randinit_mt(ctx->state);
+    gmp_randseed_ui(ctx->state, time(NULL));
+
+    // p and q searched concurrently on all cores
+    ctx->keygen = rsa_keygen_create(0, (unsigned long)time(NULL));
+    if (!ctx->keygen) {
+        gmp_randclear(ctx->state);
+        return -1;
+    }
+
+    // Sized for the largest key so no size in a sweep reallocates
+    mp_bitcnt_t mod_bits = 2 * MAX_BITS + 64;
+    mpz_init2(ctx->p, MAX_BITS);
+    mpz_init2(ctx->q, MAX_BITS);
+    mpz_init2(ctx->p1, MAX_BITS);
+    mpz_init2(ctx->q1, MAX_BITS);
+    mpz_init2(ctx->N, mod_bits);
+    mpz_init2(ctx->phi, mod_bits);
+    mpz_init2(ctx->d, mod_bits);
+    mpz_init2(ctx->m, mod_bits);
+    mpz_init2(ctx->c, mod_bits);
+    mpz_init2(ctx->m_prime, mod_bits);
+    mpz_init2(ctx->m_crt, mod_bits);
+    mpz_init2(ctx->m_ct, mod_bits);
+    mpz_init_set_ui(ctx->e, 65537); // common exponent
+    rsa_key_init(&ctx->key);
+
+    ctx->store_path = store_path;
+    ctx->store = NULL;
+    if (store_path) {
+        uint64_t start = ct_start();
+        ctx->store = rsa_keystore_open(store_path);
+        uint64_t end = ct_stop();
+        if (ctx->store)
+            printf("Key store %s: %d keys mapped in %llu cycles\n", store_path,
+                   rsa_keystore_count(ctx->store), (unsigned long long)ct_elapsed(start, end));
+        else
+            printf("Key store %s: not found, generated keys will be saved there\n", store_path);
+    }
+    return 0;
+}
+
+static void rsa_ctx_clear(RSA_CTX *ctx) {
+    rsa_keystore_close(ctx->store);
+    rsa_key_clear(&ctx->key);
+    mpz_clears(ctx->p, ctx->q, ctx->N, ctx->phi, ctx->e, ctx->d, ctx->m, ctx->c,
+               ctx->m_prime, ctx->p1, ctx->q1, ctx->m_crt, ctx->m_ct, NULL);
+    rsa_keygen_destroy(ctx->keygen);
+    gmp_randclear(ctx->state);
+}
+
+// Main RSA test function; returns 0 when all decryptions recover the message
+int rsa_test(RSA_CTX *ctx, int BIT_SIZE, int iterations, RSA_RESULT *res) {
+    printf("\n\n===============================================\n");
+    printf("    RSA TESTING WITH %d-BIT PRIME NUMBERS\n", BIT_SIZE);
+    printf("===============================================\n");
+    printf("Pseudo-Random Generator (PRG): GMP Mersenne Twister (gmp_randinit_mt)\n");
+
+    // Shorthands for the shared integers
+    mpz_ptr p = ctx->p, q = ctx->q, N = ctx->N, phi = ctx->phi, e = ctx->e, d = ctx->d;
+    mpz_ptr m = ctx->m, c = ctx->c, m_prime = ctx->m_prime;
+    mpz_ptr p1 = ctx->p1, q1 = ctx->q1, m_crt = ctx->m_crt, m_ct = ctx->m_ct;
+    RSA_KEY *key = &ctx->key;
+
+    memset(res, 0, sizeof *res);
+    res->bits = BIT_SIZE;
+
+    // A stored key replaces the whole prime generation loop
+    RSA_KEY view;
+    MONT_CTX view_mont[3];      // n, p, q contexts as stored with the key
+    int slot = ctx->store ? rsa_keystore_find(ctx->store, BIT_SIZE) : -1;
+    if (slot >= 0) {
+        uint64_t start = ct_start();
+        rsa_keystore_get(ctx->store, slot, &view, view_mont);
+        mpz_set(p, view.p);
+        mpz_set(q, view.q);
+        uint64_t end = ct_stop();
+        printf("Loaded %d-bit key #%d from %s in %llu cycles (prime generation skipped)\n",
+               BIT_SIZE, slot, ctx->store_path, (unsigned long long)ct_elapsed(start, end));
+    } else {
+        CT_STATS gen_stats;
+        ct_stats_reset(&gen_stats);
+
+        // Prime generation loop with timing
+        printf("Generating %d-bit prime pairs for %d iterations on %d threads...\n",
+               BIT_SIZE, iterations, rsa_keygen_threads(ctx->keygen));
+        int last_pct = -1;
+        for (int i = 0; i < iterations; i++) {
+            uint64_t start = ct_start();
+            rsa_keygen_primes(ctx->keygen, p, q, BIT_SIZE);
+            uint64_t end = ct_stop();
+            ct_stats_add(&gen_stats, ct_elapsed(start, end));
+            int pct = (int)((i + 1) * 100LL / iterations);
+            if (pct != last_pct) {          // redraw only when the percentage moves
+                print_progress_bar(i + 1, iterations);
+                last_pct = pct;
+            }
+        }
+
+        // Output prime generation stats
+        printf("\n\n=== Prime Generation Timing for %d-bit Primes ===\n", BIT_SIZE);
+        printf("Minimum cycles: %llu\n", (unsigned long long)gen_stats.min);
+        printf("Maximum cycles: %llu\n", (unsigned long long)gen_stats.max);
+        printf("Average cycles: %.2f\n", ct_stats_avg(&gen_stats));
+        ct_csv_report("rsa", "prime_pair", BIT_SIZE, &gen_stats, NULL);
+        res->prime_pair = ct_stats_avg(&gen_stats);
+    }
+
+    // Print final primes used
+    printf("\nFinal prime p:\n"); gmp_printf("%Zd\n", p);
+    printf("\nFinal prime q:\n"); gmp_printf("%Zd\n", q);
+
+    // Step 2a: Compute N = p * q
+    uint64_t start, end;
+    start = ct_start();
+    mpz_mul(N, p, q);
+    end = ct_stop();
+    printf("\nStep 2a (N = p × q): %llu cycles\n", (unsigned long long)ct_elapsed(start, end));
+    printf("RSA Modulus N:\n"); gmp_printf("%Zd\n", N);
+
+    // Step 2b: Compute φ(N) = (p−1)(q−1)
+    start = ct_start();
+    mpz_sub_ui(p1, p, 1);
+    mpz_sub_ui(q1, q, 1);
+    mpz_mul(phi, p1, q1);
+    end = ct_stop();
+    printf("\nStep 2b (φ(N) = (p−1)(q−1)): %llu cycles\n", (unsigned long long)ct_elapsed(start, end));
+    printf("Euler's Totient φ(N):\n"); gmp_printf("%Zd\n", phi);
+
+    // Step 3: Key generation (e, d)
+    start = ct_start();
+    if (mpz_invert(d, e, phi) == 0) {
+        printf("Error: e has no inverse mod φ(N)\n");
+        return -1;
+    }
+    end = ct_stop();
+    printf("\nStep 3 (Private key generation): %llu cycles\n", (unsigned long long)ct_elapsed(start, end));
+    printf("Private key d:\n"); gmp_printf("%Zd\n", d);
+
+    // Step 4a: Message one bit shorter than N, so m < N for every modulus
+    int msg_bits = (int)mpz_sizeinbase(N, 2) - 1;
+    start = ct_start();
+    mpz_urandomb(m, ctx->state, msg_bits);
+    mpz_setbit(m, msg_bits - 1);
+    end = ct_stop();
+    printf("\nStep 4a (Message generation %d-bit): %llu cycles\n", msg_bits,
+           (unsigned long long)ct_elapsed(start, end));
+    printf("Original %d-bit message (m):\n", msg_bits); gmp_printf("%Zd\n", m);
+
+    // Step 4b: Encryption c = m^e mod N
+    start = ct_start();
+    mpz_powm(c, m, e, N);
+    end = ct_stop();
+    printf("\nStep 4b (Encryption): %llu cycles\n", (unsigned long long)ct_elapsed(start, end));
+    printf("Encrypted message (c):\n"); gmp_printf("%Zd\n", c);
+
+    // Step 4c: Decryption m' = c^d mod N
+    start = ct_start();
+    mpz_powm(m_prime, c, d, N);
+    end = ct_stop();
+    uint64_t plain_cycles = ct_elapsed(start, end);
+    printf("\nStep 4c (Decryption): %llu cycles\n", (unsigned long long)plain_cycles);
+    printf("Decrypted message (m'):\n"); gmp_printf("%Zd\n", m_prime);
+
+    // Step 4c-CRT: Decryption with precomputed dP, dQ, qInv (two half-size powms + Garner);
+    // a stored key is used in place, straight from the mapping
+    if (slot >= 0) {
+        key = &view;
+    } else {
+        rsa_key_from_primes(key, p, q, e);
+        if (ctx->store_path && rsa_keystore_append(ctx->store_path, key) == 0)
+            printf("\nSaved the %d-bit key to %s\n", BIT_SIZE, ctx->store_path);
+    }
+    start = ct_start();
+    rsa_decrypt_crt(m_crt, c, key);
+    end = ct_stop();
+    uint64_t crt_cycles = ct_elapsed(start, end);
+    printf("\nStep 4c-CRT (Decryption with CRT): %llu cycles (%.2fx faster than Step 4c)\n",
+           (unsigned long long)crt_cycles, crt_cycles ? (double)plain_cycles / (double)crt_cycles : 0.0);
+
+    // Step 4c-CT: constant-time CRT (mpz_powm_sec) on a blinded base; the
+    // blinding pair comes from one inversion here and is squared on each call
+    RSA_BLINDING blind;
+    rsa_blinding_init(&blind, key, ctx->state);
+    start = ct_start();
+    rsa_decrypt_ct(m_ct, c, key, &blind);
+    end = ct_stop();
+    uint64_t ct_cycles = ct_elapsed(start, end);
+    printf("\nStep 4c-CT (Constant-time blinded decryption): %llu cycles (%.2fx vs Step 4c-CRT)\n",
+           (unsigned long long)ct_cycles, crt_cycles ? (double)ct_cycles / (double)crt_cycles : 0.0);
+
+    // Averaged comparison: single-shot numbers above include cold caches
+    CT_STATS enc_stats, plain_stats, crt_stats, ct_stats;
+    ct_stats_reset(&enc_stats);
+    ct_stats_reset(&plain_stats);
+    ct_stats_reset(&crt_stats);
+    ct_stats_reset(&ct_stats);
+    for (int i = 0; i < DECRYPT_REPS; i++) {
+        start = ct_start();
+        rsa_encrypt(c, m, key);
+        end = ct_stop();
+        ct_stats_add(&enc_stats, ct_elapsed(start, end));
+        start = ct_start();
+        rsa_decrypt(m_prime, c, key);
+        end = ct_stop();
+        ct_stats_add(&plain_stats, ct_elapsed(start, end));
+        start = ct_start();
+        rsa_decrypt_crt(m_crt, c, key);
+        end = ct_stop();
+        ct_stats_add(&crt_stats, ct_elapsed(start, end));
+        start = ct_start();
+        rsa_decrypt_ct(m_ct, c, key, &blind);
+        end = ct_stop();
+        ct_stats_add(&ct_stats, ct_elapsed(start, end));
+    }
+    printf("Decryption over %d runs: plain %.2f cycles, CRT %.2f cycles (%.2fx), "
+           "constant-time CRT + blinding %.2f cycles (%.2fx of CRT)\n", DECRYPT_REPS,
+           ct_stats_avg(&plain_stats), ct_stats_avg(&crt_stats),
+           ct_stats_avg(&plain_stats) / ct_stats_avg(&crt_stats),
+           ct_stats_avg(&ct_stats), ct_stats_avg(&ct_stats) / ct_stats_avg(&crt_stats));
+    ct_csv_report("rsa", "encrypt", BIT_SIZE, &enc_stats, NULL);
+    ct_csv_report("rsa", "decrypt", BIT_SIZE, &plain_stats, NULL);
+    ct_csv_report("rsa", "decrypt_crt", BIT_SIZE, &crt_stats, NULL);
+    ct_csv_report("rsa", "decrypt_ct", BIT_SIZE, &ct_stats, NULL);
+    res->encrypt = ct_stats_avg(&enc_stats);
+    res->decrypt = ct_stats_avg(&plain_stats);
+    res->decrypt_crt = ct_stats_avg(&crt_stats);
+    res->decrypt_ct = ct_stats_avg(&ct_stats);
+    rsa_blinding_clear(&blind);
+
+    // Step 4d: Verify message correctness and time it
+    start = ct_start();
+    int cmp = mpz_cmp(m, m_prime) | mpz_cmp(m, m_crt) | mpz_cmp(m, m_ct);
+    end = ct_stop();
+    printf("\nStep 4d (Message verification): %llu cycles\n", (unsigned long long)ct_elapsed(start, end));
+
+    if (cmp == 0)
+        printf("Message verification: ✅ SUCCESS\n");
+    else
+        printf("Message verification: ❌ FAILED\n");
+    res->ok = cmp == 0;
+    return cmp == 0 ? 0 : -1;
+}
+
+static void usage(const char *prog) {
+    fprintf(stderr, "Usage: %s [-n iterations] [-k keystore] [prime_bits ... | sweep]\n"
+                    "  prime_bits between %d and %d (default: 512 768 1024)\n",
+            prog, MIN_BITS, MAX_BITS);
+}
+
+int main(int argc, char **argv) {
+    int iterations = ITERATIONS;
+    const char *store_path = NULL;
+    int sizes[64];
+    int nsizes = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+            iterations = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "-k") == 0 && i + 1 < argc) {
+            store_path = argv[++i];
+        } else if (strcmp(argv[i], "sweep") == 0) {
+            for (size_t s = 0; s < sizeof SWEEP_SIZES / sizeof SWEEP_SIZES[0] && nsizes < 64; s++)
+                sizes[nsizes++] = SWEEP_SIZES[s];
+        } else {
+            int bits = atoi(argv[i]);
+            if (bits < MIN_BITS || bits > MAX_BITS || nsizes == 64) {
+                usage(argv[0]);
+                return 1;
+            }
+            sizes[nsizes++] = bits;
+        }
+    }
+    if (iterations < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+    if (nsizes == 0) {
+        memcpy(sizes, DEFAULT_SIZES, sizeof DEFAULT_SIZES);
+        nsizes = sizeof DEFAULT_SIZES / sizeof DEFAULT_SIZES[0];
+    }
+
+    ct_init();
+    RSA_CTX ctx;
+    if (rsa_ctx_init(&ctx, store_path) != 0) {
+        printf("Error: could not start key generation threads\n");
+        return 1;
+    }
+
+    RSA_RESULT res[64];
+    int failed = 0;
+    for (int i = 0; i < nsizes; i++)
+        failed |= rsa_test(&ctx, sizes[i], iterations, &res[i]) != 0;
+
+    if (nsizes > 1) {
+        printf("\n\n=== Summary (average cycles) ===\n");
+        printf("%6s %14s %12s %14s %14s %14s %6s\n", "bits", "prime pair", "encrypt",
+               "decrypt", "decrypt CRT", "decrypt CT", "ok");
+        for (int i = 0; i < nsizes; i++)
+            printf("%6d %14.0f %12.0f %14.0f %14.0f %14.0f %6s\n", res[i].bits,
+                   res[i].prime_pair, res[i].encrypt, res[i].decrypt,
+                   res[i].decrypt_crt, res[i].decrypt_ct, res[i].ok ? "yes" : "NO");
+    }
+
+    rsa_ctx_clear(&ctx);
+    return failed;
+}
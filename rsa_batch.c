@@ -0,0 +1,341 @@
+/*
+Batch RSA encryption / signature verification with e = 65537 (see rsa_batch.h)
+plus a throughput benchmark.
+
+To compile:
+    make rsa_batch
+
+To run:
+    ./build/bin/rsa_batch [modulus_bits=2048] [count=2000] [max_threads=nproc]
+
+Verifies `count` signatures spread over a handful of keys with mpz_powm, with
+the 65537 chain on one thread, and with the batch engine on 1, 2, 4, ...
+max_threads workers; exits non-zero if any path disagrees.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <gmp.h>
+
+#include "rsa_batch.h"
+#include "worker_pool.h"
+#include "rsa_key.h"
+#include "montgomery.h"
+#include "cycle_timer.h"
+
+#define RB_CHUNK 8              // items claimed per queue operation
+
+/* ---- 65537 chain on Montgomery rows from montgomery.h ---- */
+
+void rsa_pow65537(mpz_t out, const mpz_t m, const mpz_t n) {
+    mp_size_t len = (mp_size_t)mpz_size(n);
+    if (len == 0 || len > RSA_BATCH_MAX_LIMBS || mpz_even_p(n)
+        || mpz_sgn(m) < 0 || mpz_cmp(m, n) >= 0) {
+        mpz_t e;
+        mpz_init_set_ui(e, 65537);
+        mpz_powm(out, m, e, n);
+        mpz_clear(e);
+        return;
+    }
+
+    const mp_limb_t *np = mpz_limbs_read(n);
+    mp_limb_t ninv = mont_ninv(np[0]);
+    mp_limb_t mp[RSA_BATCH_MAX_LIMBS];          // m, zero-padded to len limbs
+    mp_limb_t x[RSA_BATCH_MAX_LIMBS];
+    mp_limb_t t[2 * RSA_BATCH_MAX_LIMBS];
+    mp_limb_t q[RSA_BATCH_MAX_LIMBS + 1];
+
+    mp_size_t ml = (mp_size_t)mpz_size(m);
+    memset(mp, 0, len * sizeof *mp);
+    if (ml) mpn_copyi(mp, mpz_limbs_read(m), ml);
+
+    // x = m * R mod n
+    memset(t, 0, len * sizeof *t);
+    mpn_copyi(t + len, mp, len);
+    mpn_tdiv_qr(q, x, 0, t, 2 * len, np, len);
+
+    // 65537 = 2^16 + 1: square 16 times in Montgomery form ...
+    for (int i = 0; i < 16; i++) {
+        mpn_sqr(t, x, len);
+        mont_reduce(x, t, np, len, ninv);
+    }
+    // ... then multiply by the plain m, which also leaves Montgomery form
+    mpn_mul_n(t, x, mp, len);
+    mont_reduce(x, t, np, len, ninv);
+
+    mp_limb_t *op = mpz_limbs_write(out, len);
+    mpn_copyi(op, x, len);
+    mpz_limbs_finish(out, len);
+}
+
+/* ---- Worker pool with per-worker ranges and stealing ---- */
+
+enum { RB_ENCRYPT, RB_VERIFY };
+
+typedef struct {
+    RSA_BATCH *b;
+    int id;
+    atomic_size_t next;         // next unclaimed index of this worker's range
+    size_t end;
+    mpz_t tmp;
+    size_t valid;
+} RB_WORKER;
+
+struct RSA_BATCH {
+    WORKER_POOL pool;
+    RB_WORKER *workers;
+
+    // current batch
+    int mode;
+    mpz_t *out, *msg, *sig, *mod;
+    int *ok;
+};
+
+static int rb_item(RSA_BATCH *b, size_t i, mpz_t tmp) {
+    if (b->mode == RB_ENCRYPT) {
+        rsa_pow65537(b->out[i], b->msg[i], b->mod[i]);
+        return 1;
+    }
+    rsa_pow65537(tmp, b->sig[i], b->mod[i]);
+    int ok = mpz_cmp(tmp, b->msg[i]) == 0;
+    if (b->ok) b->ok[i] = ok;
+    return ok;
+}
+
+/* Claims up to RB_CHUNK items from victim's range; returns 0 when it is empty.
+   Owner and thieves share the same cursor, so no item is handed out twice. */
+static int rb_claim(RB_WORKER *victim, size_t *lo, size_t *hi) {
+    if (atomic_load_explicit(&victim->next, memory_order_relaxed) >= victim->end)
+        return 0;
+    size_t k = atomic_fetch_add(&victim->next, RB_CHUNK);
+    if (k >= victim->end) return 0;
+    *lo = k;
+    *hi = k + RB_CHUNK < victim->end ? k + RB_CHUNK : victim->end;
+    return 1;
+}
+
+static void rb_drain(RB_WORKER *w) {
+    RSA_BATCH *b = w->b;
+    size_t lo, hi;
+    w->valid = 0;
+    // own range first, then steal round-robin starting at the next worker
+    int n = b->pool.nthreads;
+    for (int v = 0; v < n; v++) {
+        RB_WORKER *victim = &b->workers[(w->id + v) % n];
+        while (rb_claim(victim, &lo, &hi))
+            for (size_t i = lo; i < hi; i++)
+                w->valid += (size_t)rb_item(b, i, w->tmp);
+    }
+}
+
+static void rb_job(void *arg, int id) {
+    RSA_BATCH *b = arg;
+    rb_drain(&b->workers[id]);
+}
+
+RSA_BATCH *rsa_batch_create(int threads) {
+    threads = worker_pool_size(threads);
+    RSA_BATCH *b = calloc(1, sizeof *b);
+    if (!b) return NULL;
+    b->workers = calloc((size_t)threads, sizeof *b->workers);
+    if (!b->workers) { free(b); return NULL; }
+
+    for (int i = 0; i < threads; i++) {
+        RB_WORKER *w = &b->workers[i];
+        w->b = b;
+        w->id = i;
+        atomic_init(&w->next, 0);
+        mpz_init2(w->tmp, 64 * RSA_BATCH_MAX_LIMBS);
+    }
+    // rb_run splits each batch over however many workers started
+    int started = worker_pool_start(&b->pool, threads, rb_job, b);
+    for (int i = started; i < threads; i++) mpz_clear(b->workers[i].tmp);
+    if (started == 0) {
+        free(b->workers);
+        free(b);
+        return NULL;
+    }
+    return b;
+}
+
+void rsa_batch_destroy(RSA_BATCH *b) {
+    if (!b) return;
+    int n = b->pool.nthreads;
+    worker_pool_stop(&b->pool);
+    for (int i = 0; i < n; i++) mpz_clear(b->workers[i].tmp);
+    free(b->workers);
+    free(b);
+}
+
+int rsa_batch_threads(const RSA_BATCH *b) {
+    return b->pool.nthreads;
+}
+
+static size_t rb_run(RSA_BATCH *b, size_t count) {
+    // too small to be worth waking the pool
+    int n = b->pool.nthreads;
+    if (n == 1 || count <= RB_CHUNK) {
+        size_t valid = 0;
+        for (size_t i = 0; i < count; i++)
+            valid += (size_t)rb_item(b, i, b->workers[0].tmp);
+        return valid;
+    }
+
+    for (int i = 0; i < n; i++) {
+        RB_WORKER *w = &b->workers[i];
+        atomic_store(&w->next, count * (size_t)i / (size_t)n);
+        w->end = count * (size_t)(i + 1) / (size_t)n;
+    }
+    worker_pool_run(&b->pool);
+
+    size_t valid = 0;
+    for (int i = 0; i < n; i++) valid += b->workers[i].valid;
+    return valid;
+}
+
+void rsa_batch_encrypt(RSA_BATCH *b, mpz_t *out, mpz_t *msg, mpz_t *mod, size_t count) {
+    b->mode = RB_ENCRYPT;
+    b->out = out;
+    b->msg = msg;
+    b->mod = mod;
+    rb_run(b, count);
+}
+
+size_t rsa_batch_verify(RSA_BATCH *b, int *ok, mpz_t *sig, mpz_t *msg, mpz_t *mod,
+                        size_t count) {
+    b->mode = RB_VERIFY;
+    b->ok = ok;
+    b->sig = sig;
+    b->msg = msg;
+    b->mod = mod;
+    return rb_run(b, count);
+}
+
+/* ---- Throughput benchmark ---- */
+
+#ifndef CRYPTO_NO_MAIN
+#define NKEYS 8
+#define REPS  5
+
+int main(int argc, char **argv) {
+    int bits     = argc > 1 ? atoi(argv[1]) : 2048;
+    int count    = argc > 2 ? atoi(argv[2]) : 2000;
+    int max_thr  = argc > 3 ? atoi(argv[3]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (bits < 64 || count < 1 || max_thr < 1) {
+        fprintf(stderr, "Usage: %s [modulus_bits] [count] [max_threads]\n", argv[0]);
+        return 1;
+    }
+
+    ct_init();
+    gmp_randstate_t rng;
+    gmp_randinit_mt(rng);
+    gmp_randseed_ui(rng, 0xC0FFEEul);
+
+    RSA_KEY keys[NKEYS];
+    for (int k = 0; k < NKEYS; k++) {
+        rsa_key_init(&keys[k]);
+        rsa_key_generate(&keys[k], bits / 2, rng);
+    }
+
+    mpz_t *msg = malloc((size_t)count * sizeof *msg);
+    mpz_t *sig = malloc((size_t)count * sizeof *sig);
+    mpz_t *mod = malloc((size_t)count * sizeof *mod);
+    int *ok = malloc((size_t)count * sizeof *ok);
+    if (!msg || !sig || !mod || !ok) return 1;
+    for (int i = 0; i < count; i++) {
+        const RSA_KEY *key = &keys[i % NKEYS];
+        mpz_inits(msg[i], sig[i], NULL);
+        mpz_init_set(mod[i], key->n);
+        mpz_urandomm(msg[i], rng, key->n);
+        rsa_sign(sig[i], msg[i], key);
+    }
+
+    printf("RSA e=65537 verification, %d-bit moduli, %d signatures, %d keys\n",
+           bits, count, NKEYS);
+    printf("%-10s %14s %14s %10s\n", "variant", "cycles/verify", "verifies/s", "speedup");
+
+    int failed = 0;
+    double base = 0.0;
+    mpz_t e, t;
+    mpz_init_set_ui(e, 65537);
+    mpz_init(t);
+    CT_STATS stats;
+
+    // reference: one generic mpz_powm per message, as rsa_test does
+    ct_stats_reset(&stats);
+    for (int r = 0; r < REPS; r++) {
+        int valid = 0;
+        uint64_t t0 = ct_start();
+        for (int i = 0; i < count; i++) {
+            mpz_powm(t, sig[i], e, mod[i]);
+            valid += mpz_cmp(t, msg[i]) == 0;
+        }
+        ct_stats_add(&stats, ct_elapsed(t0, ct_stop()));
+        failed |= valid != count;
+    }
+    base = ct_stats_avg(&stats) / count;
+    printf("%-10s %14.0f %14.0f %9.2fx\n", "mpz_powm", base, ct_hz() / base, 1.0);
+    ct_csv_report("rsa_batch", "mpz_powm", (size_t)bits, &stats, NULL);
+
+    // addition chain, caller thread only
+    ct_stats_reset(&stats);
+    for (int r = 0; r < REPS; r++) {
+        int valid = 0;
+        uint64_t t0 = ct_start();
+        for (int i = 0; i < count; i++) {
+            rsa_pow65537(t, sig[i], mod[i]);
+            valid += mpz_cmp(t, msg[i]) == 0;
+        }
+        ct_stats_add(&stats, ct_elapsed(t0, ct_stop()));
+        failed |= valid != count;
+    }
+    double per = ct_stats_avg(&stats) / count;
+    printf("%-10s %14.0f %14.0f %9.2fx\n", "chain", per, ct_hz() / per, base / per);
+    ct_csv_report("rsa_batch", "chain", (size_t)bits, &stats, NULL);
+
+    for (int th = 1; ; th = (th * 2 > max_thr && th < max_thr) ? max_thr : th * 2) {
+        RSA_BATCH *b = rsa_batch_create(th);
+        if (!b) return 1;
+        ct_stats_reset(&stats);
+        for (int r = 0; r < REPS; r++) {
+            uint64_t t0 = ct_start();
+            size_t valid = rsa_batch_verify(b, ok, sig, msg, mod, (size_t)count);
+            ct_stats_add(&stats, ct_elapsed(t0, ct_stop()));
+            failed |= valid != (size_t)count;
+        }
+        // a corrupted signature must be rejected
+        mpz_add_ui(sig[0], sig[0], 1);
+        failed |= rsa_batch_verify(b, ok, sig, msg, mod, (size_t)count) != (size_t)count - 1 || ok[0];
+        mpz_sub_ui(sig[0], sig[0], 1);
+        rsa_batch_destroy(b);
+
+        char variant[16];
+        snprintf(variant, sizeof variant, "t%d", th);
+        per = ct_stats_avg(&stats) / count;
+        printf("%-10s %14.0f %14.0f %9.2fx\n", variant, per, ct_hz() / per, base / per);
+        ct_csv_report("rsa_batch", variant, (size_t)bits, &stats, NULL);
+        if (th >= max_thr) break;
+    }
+
+    // batch encryption must agree with mpz_powm
+    RSA_BATCH *b = rsa_batch_create(max_thr);
+    rsa_batch_encrypt(b, sig, msg, mod, (size_t)count);
+    rsa_batch_destroy(b);
+    for (int i = 0; i < count; i++) {
+        mpz_powm(t, msg[i], e, mod[i]);
+        failed |= mpz_cmp(t, sig[i]) != 0;
+    }
+
+    printf("Result: %s\n", failed ? "MISMATCH" : "all paths agree");
+
+    for (int i = 0; i < count; i++) mpz_clears(msg[i], sig[i], mod[i], NULL);
+    free(msg); free(sig); free(mod); free(ok);
+    for (int k = 0; k < NKEYS; k++) rsa_key_clear(&keys[k]);
+    mpz_clears(e, t, NULL);
+    gmp_randclear(rng);
+    return failed;
+}
+#endif /* CRYPTO_NO_MAIN */
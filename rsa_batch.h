@@ -0,0 +1,38 @@
+// rsa_batch.h
+// Batch RSA public-key operations for e = 65537.
+//
+// Every item is an independent (message, modulus) pair, as in a verification
+// service checking signatures from many keys. Each exponentiation runs the
+// fixed addition chain for 65537 (16 Montgomery squarings, 1 multiply) on
+// stack limbs instead of a generic mpz_powm. A batch is split into one range
+// per worker thread; a worker that drains its own range steals chunks from
+// the others.
+
+#ifndef RSA_BATCH_H
+#define RSA_BATCH_H
+
+#include <stddef.h>
+#include <gmp.h>
+
+#define RSA_BATCH_MAX_LIMBS 64  // 4096-bit moduli; larger ones fall back to mpz_powm
+
+typedef struct RSA_BATCH RSA_BATCH;
+
+// out = m^65537 mod n. Takes the Montgomery path for odd n up to
+// RSA_BATCH_MAX_LIMBS limbs and 0 <= m < n, mpz_powm otherwise.
+void rsa_pow65537(mpz_t out, const mpz_t m, const mpz_t n);
+
+// threads <= 0 uses every online CPU. If some threads cannot be started the
+// pool keeps the ones that did (rsa_batch_threads); NULL if none start.
+RSA_BATCH *rsa_batch_create(int threads);
+void rsa_batch_destroy(RSA_BATCH *b);
+int rsa_batch_threads(const RSA_BATCH *b);
+
+// out[i] = msg[i]^65537 mod mod[i] for i < count
+void rsa_batch_encrypt(RSA_BATCH *b, mpz_t *out, mpz_t *msg, mpz_t *mod, size_t count);
+
+// ok[i] = (sig[i]^65537 mod mod[i] == msg[i]); returns the number of valid signatures
+size_t rsa_batch_verify(RSA_BATCH *b, int *ok, mpz_t *sig, mpz_t *msg, mpz_t *mod,
+                        size_t count);
+
+#endif /* RSA_BATCH_H */
@@ -0,0 +1,531 @@
+/*
+Fiat batch RSA decryption (see rsa_fiat.h) plus a throughput-vs-latency
+benchmark.
+
+To compile:
+    make rsa_fiat
+
+To run:
+    ./build/bin/rsa_fiat [prime_bits=512] [batches=200]
+
+For batch sizes 1, 2, 4, 6 and 8, prints the cycles one batch takes (the
+latency every request in it sees), the cycles per decryption (throughput)
+and the speedup over single CRT decryption. Then runs the pending-request
+queue with 1, 2, 4 and 8 client threads (`batches` requests each) and prints
+the same columns per request. Exits non-zero if any result differs from
+single decryption.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <gmp.h>
+
+#include "rsa_fiat.h"
+#include "montgomery.h"
+#include "cycle_timer.h"
+
+static const unsigned long FIAT_EXPONENTS[FIAT_MAX_BATCH] = {3, 5, 7, 11, 13, 17, 19, 23};
+
+typedef struct {
+    int lo, hi;                 // batch items covered
+    int left, right;            // child nodes, -1 for a leaf
+    unsigned long e;            // product of the exponents below
+    mpz_t v;                    // product of c_i^(e / e_i) mod N
+} FIAT_NODE;
+
+struct FIAT_CTX {
+    const FIAT_KEYSET *ks;
+    FIAT_NODE node[2 * FIAT_MAX_BATCH - 1];
+    int nodes;
+    mpz_t t, u, root, dE;
+    mpz_t *m, *c;
+    const int *idx;
+    int pos[FIAT_MAX_BATCH];    // tree leaf -> batch item
+};
+
+/* ---- Key set ---- */
+
+int fiat_keyset_generate(FIAT_KEYSET *ks, int prime_bits, int count, gmp_randstate_t state) {
+    if (count < 1 || count > FIAT_MAX_BATCH || prime_bits < 16) return -1;
+
+    mpz_t p, q, e, t;
+    mpz_inits(p, q, e, t, NULL);
+    rsa_key_init(&ks->key);
+    ks->count = count;
+    for (int i = 0; i < count; i++) {
+        ks->e[i] = FIAT_EXPONENTS[i];
+        mpz_inits(ks->dP[i], ks->dQ[i], NULL);
+    }
+
+    // every e[i] needs an inverse mod p-1 and q-1: no prime with r == 1 mod e[i]
+    for (int which = 0; which < 2; which++) {
+        mpz_ptr r = which ? q : p;
+        int ok;
+        do {
+            rsa_generate_prime(r, state, prime_bits);
+            ok = !which || mpz_cmp(p, q) != 0;
+            for (int i = 0; i < count && ok; i++)
+                ok = mpz_fdiv_ui(r, ks->e[i]) != 1;
+        } while (!ok);
+    }
+    mpz_set_ui(e, ks->e[0]);
+    rsa_key_from_primes(&ks->key, p, q, e);
+
+    for (int i = 0; i < count; i++) {
+        mpz_set_ui(e, ks->e[i]);
+        mpz_sub_ui(t, p, 1);
+        mpz_invert(ks->dP[i], e, t);
+        mpz_sub_ui(t, q, 1);
+        mpz_invert(ks->dQ[i], e, t);
+    }
+
+    mpz_clears(p, q, e, t, NULL);
+    return 0;
+}
+
+void fiat_keyset_clear(FIAT_KEYSET *ks) {
+    for (int i = 0; i < ks->count; i++) mpz_clears(ks->dP[i], ks->dQ[i], NULL);
+    rsa_key_clear(&ks->key);
+}
+
+void fiat_encrypt(mpz_t c, const mpz_t m, const FIAT_KEYSET *ks, int i) {
+    mpz_powm_ui(c, m, ks->e[i], ks->key.n);
+}
+
+/* m = Garner(m1 mod p, m2 mod q); m1 is clobbered */
+static void fiat_garner(mpz_t m, mpz_t m1, const mpz_t m2, const RSA_KEY *key) {
+    mpz_sub(m1, m1, m2);
+    mpz_mul(m1, m1, key->qInv);
+    mpz_mod(m1, m1, key->p);
+    mpz_mul(m1, m1, key->q);
+    mpz_add(m, m2, m1);
+}
+
+void fiat_decrypt(mpz_t m, const mpz_t c, const FIAT_KEYSET *ks, int i) {
+    const RSA_KEY *key = &ks->key;
+    mpz_t m1, m2;
+    mpz_init2(m1, 2 * mpz_sizeinbase(key->n, 2));
+    mpz_init2(m2, 2 * mpz_sizeinbase(key->n, 2));
+    crypto_powm_ctx(m1, c, ks->dP[i], key->p, key->mont ? &key->mont[1] : NULL);
+    crypto_powm_ctx(m2, c, ks->dQ[i], key->q, key->mont ? &key->mont[2] : NULL);
+    fiat_garner(m, m1, m2, key);
+    mpz_clears(m1, m2, NULL);
+}
+
+/* ---- Batch ---- */
+
+FIAT_CTX *fiat_ctx_create(const FIAT_KEYSET *ks) {
+    FIAT_CTX *ctx = malloc(sizeof *ctx);
+    if (!ctx) return NULL;
+    mp_bitcnt_t bits = 2 * mpz_sizeinbase(ks->key.n, 2) + 64;
+    ctx->ks = ks;
+    for (int i = 0; i < 2 * FIAT_MAX_BATCH - 1; i++) mpz_init2(ctx->node[i].v, bits);
+    mpz_init2(ctx->t, bits);
+    mpz_init2(ctx->u, bits);
+    mpz_init2(ctx->root, bits);
+    mpz_init2(ctx->dE, bits);
+    return ctx;
+}
+
+void fiat_ctx_destroy(FIAT_CTX *ctx) {
+    if (!ctx) return;
+    for (int i = 0; i < 2 * FIAT_MAX_BATCH - 1; i++) mpz_clear(ctx->node[i].v);
+    mpz_clears(ctx->t, ctx->u, ctx->root, ctx->dE, NULL);
+    free(ctx);
+}
+
+/* Upward pass: v = v_L^e_R * v_R^e_L, e = e_L * e_R */
+static int fiat_build(FIAT_CTX *ctx, int lo, int hi) {
+    const mpz_srcptr n = ctx->ks->key.n;
+    int id = ctx->nodes++;
+    FIAT_NODE *nd = &ctx->node[id];
+    nd->lo = lo;
+    nd->hi = hi;
+    if (hi - lo == 1) {
+        nd->left = nd->right = -1;
+        nd->e = ctx->ks->e[ctx->idx[ctx->pos[lo]]];
+        mpz_mod(nd->v, ctx->c[ctx->pos[lo]], n);
+        return id;
+    }
+    int mid = lo + (hi - lo) / 2;
+    nd->left = fiat_build(ctx, lo, mid);
+    nd->right = fiat_build(ctx, mid, hi);
+    FIAT_NODE *l = &ctx->node[nd->left], *r = &ctx->node[nd->right];
+    nd->e = l->e * r->e;
+    mpz_powm_ui(ctx->t, l->v, r->e, n);
+    mpz_powm_ui(ctx->u, r->v, l->e, n);
+    mpz_mul(ctx->t, ctx->t, ctx->u);
+    mpz_mod(nd->v, ctx->t, n);
+    return id;
+}
+
+/* Downward pass: m = v^(1/e) = m_L * m_R. With X == 0 mod e_L, X == 1 mod e_R,
+   m^X = v_L^(X/e_L) * v_R^((X-1)/e_R) * m_R, which isolates m_R. m is clobbered. */
+static void fiat_percolate(FIAT_CTX *ctx, int id, mpz_t m) {
+    const mpz_srcptr n = ctx->ks->key.n;
+    FIAT_NODE *nd = &ctx->node[id];
+    if (nd->left < 0) {
+        mpz_set(ctx->m[ctx->pos[nd->lo]], m);
+        return;
+    }
+    FIAT_NODE *l = &ctx->node[nd->left], *r = &ctx->node[nd->right];
+
+    // X = e_L * (e_L^-1 mod e_R), 0 < X < e
+    mpz_set_ui(ctx->t, l->e);
+    mpz_set_ui(ctx->u, r->e);
+    mpz_invert(ctx->t, ctx->t, ctx->u);
+    unsigned long X = l->e * mpz_get_ui(ctx->t);
+
+    mpz_powm_ui(ctx->t, l->v, X / l->e, n);           // denominator
+    mpz_powm_ui(ctx->u, r->v, (X - 1) / r->e, n);
+    mpz_mul(ctx->t, ctx->t, ctx->u);
+    mpz_mod(ctx->t, ctx->t, n);
+    mpz_invert(ctx->t, ctx->t, n);
+    mpz_powm_ui(ctx->u, m, X, n);
+    mpz_mul(ctx->u, ctx->u, ctx->t);
+    mpz_mod(r->v, ctx->u, n);                         // m_R, v_R no longer needed
+
+    mpz_invert(ctx->t, r->v, n);                      // m_L = m / m_R
+    mpz_mul(ctx->u, m, ctx->t);
+    mpz_mod(l->v, ctx->u, n);
+
+    // children's v now hold their roots; recurse with copies out of the way
+    mpz_swap(m, l->v);
+    fiat_percolate(ctx, nd->left, m);
+    mpz_set(m, r->v);
+    fiat_percolate(ctx, nd->right, m);
+}
+
+int fiat_decrypt_batch(FIAT_CTX *ctx, mpz_t *m, mpz_t *c, const int *idx, int count) {
+    const FIAT_KEYSET *ks = ctx->ks;
+    unsigned used = 0;
+    for (int j = 0; j < count; j++) {
+        if (idx[j] < 0 || idx[j] >= ks->count || (used >> idx[j] & 1)) return -1;
+        used |= 1u << idx[j];
+    }
+    if (count < 2 || count > FIAT_MAX_BATCH) {
+        // nothing to share (or an oversized request): plain CRT per item
+        for (int j = 0; j < count; j++) fiat_decrypt(m[j], c[j], ks, idx[j]);
+        return 0;
+    }
+
+    // the percolation divides by node values, so only units mod N go in
+    // the tree; c = 0 or a multiple of p or q is decrypted on its own
+    int leaves = 0;
+    for (int j = 0; j < count; j++) {
+        mpz_gcd(ctx->t, c[j], ks->key.n);
+        if (mpz_cmp_ui(ctx->t, 1) == 0) ctx->pos[leaves++] = j;
+        else fiat_decrypt(m[j], c[j], ks, idx[j]);
+    }
+    if (leaves < 2) {
+        for (int k = 0; k < leaves; k++) fiat_decrypt(m[ctx->pos[k]], c[ctx->pos[k]], ks, idx[ctx->pos[k]]);
+        return 0;
+    }
+
+    ctx->m = m;
+    ctx->c = c;
+    ctx->idx = idx;
+    ctx->nodes = 0;
+    int top = fiat_build(ctx, 0, leaves);
+    FIAT_NODE *rt = &ctx->node[top];
+
+    // one full-size root: v^(1/E) by CRT with E^-1 mod p-1 and q-1
+    const RSA_KEY *key = &ks->key;
+    mpz_set_ui(ctx->u, rt->e);
+    mpz_sub_ui(ctx->t, key->p, 1);
+    mpz_invert(ctx->dE, ctx->u, ctx->t);
+    crypto_powm_ctx(ctx->root, rt->v, ctx->dE, key->p, key->mont ? &key->mont[1] : NULL);
+    mpz_sub_ui(ctx->t, key->q, 1);
+    mpz_invert(ctx->dE, ctx->u, ctx->t);
+    crypto_powm_ctx(ctx->t, rt->v, ctx->dE, key->q, key->mont ? &key->mont[2] : NULL);
+    fiat_garner(ctx->root, ctx->root, ctx->t, key);
+
+    fiat_percolate(ctx, top, ctx->root);
+    return 0;
+}
+
+/* ---- Pending-request queue ---- */
+
+typedef struct {
+    mpz_ptr m;
+    mpz_srcptr c;
+    int done;
+} FIAT_REQ;
+
+struct FIAT_QUEUE {
+    const FIAT_KEYSET *ks;
+    FIAT_CTX *ctx;
+    int min_batch;
+    long timeout_us;
+    pthread_mutex_t mu;
+    pthread_cond_t cv;                  // a slot freed or a batch finished
+    FIAT_REQ *slot[FIAT_MAX_BATCH];     // at most one pending request per exponent
+    int pending;
+    struct timespec deadline;           // when the oldest pending request times out
+    int busy;                           // a batch is running on ctx, m, c, idx
+    mpz_t m[FIAT_MAX_BATCH], c[FIAT_MAX_BATCH];
+    int idx[FIAT_MAX_BATCH];
+};
+
+FIAT_QUEUE *fiat_queue_create(const FIAT_KEYSET *ks, int min_batch, long timeout_us) {
+    FIAT_QUEUE *q = calloc(1, sizeof *q);
+    if (!q) return NULL;
+    if (!(q->ctx = fiat_ctx_create(ks))) { free(q); return NULL; }
+    q->ks = ks;
+    q->min_batch = min_batch > 0 ? min_batch : FIAT_MIN_BATCH;
+    if (q->min_batch > ks->count) q->min_batch = ks->count;
+    q->timeout_us = timeout_us >= 0 ? timeout_us : FIAT_TIMEOUT_US;
+
+    // deadlines are absolute CLOCK_MONOTONIC times
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&q->cv, &attr);
+    pthread_condattr_destroy(&attr);
+    pthread_mutex_init(&q->mu, NULL);
+    for (int i = 0; i < FIAT_MAX_BATCH; i++) mpz_inits(q->m[i], q->c[i], NULL);
+    return q;
+}
+
+void fiat_queue_destroy(FIAT_QUEUE *q) {
+    if (!q) return;
+    for (int i = 0; i < FIAT_MAX_BATCH; i++) mpz_clears(q->m[i], q->c[i], NULL);
+    pthread_cond_destroy(&q->cv);
+    pthread_mutex_destroy(&q->mu);
+    fiat_ctx_destroy(q->ctx);
+    free(q);
+}
+
+/* Takes every pending request and decrypts them; called and returns with mu held */
+static void fiat_queue_run(FIAT_QUEUE *q) {
+    FIAT_REQ *batch[FIAT_MAX_BATCH];
+    int n = 0;
+    for (int e = 0; e < q->ks->count; e++) {
+        if (!q->slot[e]) continue;
+        batch[n] = q->slot[e];
+        q->idx[n] = e;
+        mpz_set(q->c[n], q->slot[e]->c);
+        q->slot[e] = NULL;
+        n++;
+    }
+    q->pending = 0;
+    q->busy = 1;
+    pthread_cond_broadcast(&q->cv);     // the slots are free for the next batch
+    pthread_mutex_unlock(&q->mu);
+
+    if (n >= q->min_batch) {
+        fiat_decrypt_batch(q->ctx, q->m, q->c, q->idx, n);
+    } else {
+        // timed out under low load: not worth the tree
+        for (int j = 0; j < n; j++) fiat_decrypt(q->m[j], q->c[j], q->ks, q->idx[j]);
+    }
+
+    pthread_mutex_lock(&q->mu);
+    for (int j = 0; j < n; j++) {
+        mpz_set(batch[j]->m, q->m[j]);
+        batch[j]->done = 1;
+    }
+    q->busy = 0;
+    pthread_cond_broadcast(&q->cv);
+}
+
+int fiat_queue_decrypt(FIAT_QUEUE *q, mpz_t m, const mpz_t c, int i) {
+    if (i < 0 || i >= q->ks->count) return -1;
+    FIAT_REQ req = { m, c, 0 };
+
+    pthread_mutex_lock(&q->mu);
+    while (q->slot[i]) pthread_cond_wait(&q->cv, &q->mu);
+    q->slot[i] = &req;
+    if (q->pending++ == 0) {
+        clock_gettime(CLOCK_MONOTONIC, &q->deadline);
+        q->deadline.tv_nsec += q->timeout_us % 1000000 * 1000;
+        q->deadline.tv_sec += q->timeout_us / 1000000 + q->deadline.tv_nsec / 1000000000;
+        q->deadline.tv_nsec %= 1000000000;
+    }
+
+    while (!req.done) {
+        if (q->busy || q->pending == 0) {
+            pthread_cond_wait(&q->cv, &q->mu);
+            continue;
+        }
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        int expired = now.tv_sec > q->deadline.tv_sec
+                   || (now.tv_sec == q->deadline.tv_sec && now.tv_nsec >= q->deadline.tv_nsec);
+        if (q->pending >= q->min_batch || expired)
+            fiat_queue_run(q);
+        else
+            pthread_cond_timedwait(&q->cv, &q->mu, &q->deadline);
+    }
+    pthread_mutex_unlock(&q->mu);
+    return 0;
+}
+
+/* ---- Throughput vs latency ---- */
+
+#ifndef CRYPTO_NO_MAIN
+/* One client of the queue: `reqs` decryptions under its own exponent */
+typedef struct {
+    FIAT_QUEUE *q;
+    const FIAT_KEYSET *ks;
+    int e, reqs;
+    pthread_t tid;
+    CT_STATS lat;
+    int failed;
+} FIAT_CLIENT;
+
+static void *fiat_client(void *arg) {
+    FIAT_CLIENT *cl = arg;
+    gmp_randstate_t rng;
+    gmp_randinit_mt(rng);
+    gmp_randseed_ui(rng, 0xF1A7ul + (unsigned long)cl->e);
+    mpz_t msg, c, m;
+    mpz_inits(msg, c, m, NULL);
+    ct_stats_reset(&cl->lat);
+    for (int r = 0; r < cl->reqs; r++) {
+        mpz_urandomm(msg, rng, cl->ks->key.n);
+        fiat_encrypt(c, msg, cl->ks, cl->e);
+        uint64_t t0 = ct_start();
+        fiat_queue_decrypt(cl->q, m, c, cl->e);
+        ct_stats_add(&cl->lat, ct_elapsed(t0, ct_stop()));
+        cl->failed |= mpz_cmp(m, msg) != 0;
+    }
+    mpz_clears(msg, c, m, NULL);
+    gmp_randclear(rng);
+    return NULL;
+}
+
+int main(int argc, char **argv) {
+    int bits    = argc > 1 ? atoi(argv[1]) : 512;
+    int batches = argc > 2 ? atoi(argv[2]) : 200;
+    if (bits < 64 || batches < 1) {
+        fprintf(stderr, "Usage: %s [prime_bits] [batches]\n", argv[0]);
+        return 1;
+    }
+    static const int SIZES[] = {1, 2, 4, 6, 8};
+
+    ct_init();
+    gmp_randstate_t rng;
+    gmp_randinit_mt(rng);
+    gmp_randseed_ui(rng, 0xC0FFEEul);
+
+    FIAT_KEYSET ks;
+    fiat_keyset_generate(&ks, bits, FIAT_MAX_BATCH, rng);
+    FIAT_CTX *ctx = fiat_ctx_create(&ks);
+    if (!ctx) return 1;
+
+    mpz_t msg[FIAT_MAX_BATCH], c[FIAT_MAX_BATCH], m[FIAT_MAX_BATCH], ref;
+    int idx[FIAT_MAX_BATCH];
+    mpz_init(ref);
+    for (int i = 0; i < FIAT_MAX_BATCH; i++) mpz_inits(msg[i], c[i], m[i], NULL);
+
+    printf("Fiat batch RSA, %d-bit primes, exponents 3..23, %d batches per size\n", bits, batches);
+    printf("%6s %16s %16s %14s %9s\n", "batch", "latency cycles", "cycles/decrypt",
+           "decrypts/s", "speedup");
+
+    int failed = 0;
+    double single = 0.0;
+    for (size_t s = 0; s < sizeof SIZES / sizeof SIZES[0]; s++) {
+        int b = SIZES[s];
+        CT_STATS stats;
+        ct_stats_reset(&stats);
+        for (int k = 0; k < batches; k++) {
+            // a random set of distinct exponents, one ciphertext each
+            for (int j = 0; j < FIAT_MAX_BATCH; j++) idx[j] = j;
+            for (int j = FIAT_MAX_BATCH - 1; j > 0; j--) {
+                int r = (int)gmp_urandomm_ui(rng, (unsigned long)j + 1), t = idx[j];
+                idx[j] = idx[r];
+                idx[r] = t;
+            }
+            for (int j = 0; j < b; j++) {
+                mpz_urandomm(msg[j], rng, ks.key.n);
+                fiat_encrypt(c[j], msg[j], &ks, idx[j]);
+            }
+
+            uint64_t t0 = ct_start();
+            fiat_decrypt_batch(ctx, m, c, idx, b);
+            ct_stats_add(&stats, ct_elapsed(t0, ct_stop()));
+
+            for (int j = 0; j < b; j++) {
+                fiat_decrypt(ref, c[j], &ks, idx[j]);
+                failed |= mpz_cmp(m[j], msg[j]) != 0 || mpz_cmp(ref, msg[j]) != 0;
+            }
+        }
+        double per = ct_stats_avg(&stats) / b;
+        if (b == 1) single = per;
+        printf("%6d %16.0f %16.0f %14.0f %8.2fx\n", b, ct_stats_avg(&stats), per,
+               ct_hz() / per, single / per);
+
+        char variant[16];
+        snprintf(variant, sizeof variant, "batch%d", b);
+        ct_csv_report("rsa_fiat", variant, (size_t)bits, &stats, NULL);
+    }
+
+    // ciphertexts that are not units mod N (0, a multiple of p) must not
+    // disturb the other items of their batch
+    for (int j = 0; j < 4; j++) {
+        idx[j] = j;
+        mpz_urandomm(msg[j], rng, ks.key.n);
+    }
+    mpz_set_ui(msg[1], 0);
+    mpz_mul_ui(msg[2], ks.key.p, 3);
+    for (int j = 0; j < 4; j++) fiat_encrypt(c[j], msg[j], &ks, idx[j]);
+    fiat_decrypt_batch(ctx, m, c, idx, 4);
+    for (int j = 0; j < 4; j++) failed |= mpz_cmp(m[j], msg[j]) != 0;
+
+    // the queue: 1..8 client threads, one exponent each, submitting one
+    // request at a time; under low load the timeout sends items out alone
+    FIAT_QUEUE *q = fiat_queue_create(&ks, FIAT_MIN_BATCH, FIAT_TIMEOUT_US);
+    if (!q) return 1;
+    printf("\nQueue, min batch %d, timeout %d us, %d requests per client\n",
+           FIAT_MIN_BATCH, FIAT_TIMEOUT_US, batches);
+    printf("%7s %16s %16s %14s %9s\n", "clients", "latency cycles", "cycles/decrypt",
+           "decrypts/s", "speedup");
+    static const int CLIENTS[] = {1, 2, 4, 8};
+    for (size_t s = 0; s < sizeof CLIENTS / sizeof CLIENTS[0]; s++) {
+        FIAT_CLIENT cl[FIAT_MAX_BATCH];
+        int started = 0;
+        uint64_t t0 = ct_start();
+        for (int t = 0; t < CLIENTS[s]; t++, started++) {
+            cl[t] = (FIAT_CLIENT){ .q = q, .ks = &ks, .e = t, .reqs = batches };
+            if (pthread_create(&cl[t].tid, NULL, fiat_client, &cl[t]) != 0) break;
+        }
+        for (int t = 0; t < started; t++) pthread_join(cl[t].tid, NULL);
+        uint64_t wall = ct_elapsed(t0, ct_stop());
+        if (started < CLIENTS[s]) {
+            fprintf(stderr, "cannot start %d client threads\n", CLIENTS[s]);
+            failed = 1;
+            break;
+        }
+
+        CT_STATS lat;
+        ct_stats_reset(&lat);
+        for (int t = 0; t < started; t++) {
+            failed |= cl[t].failed;
+            lat.n += cl[t].lat.n;
+            lat.total += cl[t].lat.total;
+            if (cl[t].lat.min < lat.min) lat.min = cl[t].lat.min;
+            if (cl[t].lat.max > lat.max) lat.max = cl[t].lat.max;
+        }
+        double per = (double)wall / (double)lat.n;
+        printf("%7d %16.0f %16.0f %14.0f %8.2fx\n", CLIENTS[s], ct_stats_avg(&lat), per,
+               ct_hz() / per, single / per);
+
+        char variant[16];
+        snprintf(variant, sizeof variant, "queue%d", CLIENTS[s]);
+        ct_csv_report("rsa_fiat", variant, (size_t)bits, &lat, NULL);
+    }
+    fiat_queue_destroy(q);
+
+    printf("Result: %s\n", failed ? "MISMATCH" : "batch and single decryption agree");
+
+    for (int i = 0; i < FIAT_MAX_BATCH; i++) mpz_clears(msg[i], c[i], m[i], NULL);
+    mpz_clear(ref);
+    fiat_ctx_destroy(ctx);
+    fiat_keyset_clear(&ks);
+    gmp_randclear(rng);
+    return failed;
+}
+#endif /* CRYPTO_NO_MAIN */
@@ -0,0 +1,73 @@
+// rsa_fiat.h
+// Fiat batch RSA decryption.
+//
+// A key set shares one modulus N = p * q between up to FIAT_MAX_BATCH public
+// exponents, the distinct small primes 3, 5, 7, ..., 23. Ciphertexts for
+// different exponents are combined up a binary product tree into a single
+// value whose E-th root (E = product of the exponents) costs one CRT
+// exponentiation; the root is then split back down the tree with short
+// exponentiations and a few inversions. Batches of 4-8 decrypt at roughly
+// the cost of one ordinary decryption plus small-exponent work.
+//
+// FIAT_QUEUE groups decryptions that arrive one at a time from many
+// threads: requests wait until min_batch distinct exponents are pending or
+// the oldest has waited timeout_us, then go out as one batch; a batch that
+// leaves on the timeout short of min_batch (low load) is decrypted item by
+// item with single CRT instead.
+//
+// Textbook RSA with e = 3 is only safe with padding; like the rest of the
+// repo this operates on raw integers.
+
+#ifndef RSA_FIAT_H
+#define RSA_FIAT_H
+
+#include <gmp.h>
+#include "rsa_key.h"
+
+#define FIAT_MAX_BATCH 8
+#define FIAT_MIN_BATCH 4        // default queue threshold for a tree batch
+#define FIAT_TIMEOUT_US 500     // default longest queue wait before dispatch
+
+typedef struct {
+    RSA_KEY key;                        // n, p, q, qInv (e and d of exponent 0)
+    int count;                          // exponents in the set
+    unsigned long e[FIAT_MAX_BATCH];
+    mpz_t dP[FIAT_MAX_BATCH];           // e[i]^-1 mod (p-1)
+    mpz_t dQ[FIAT_MAX_BATCH];           // e[i]^-1 mod (q-1)
+} FIAT_KEYSET;
+
+// Scratch for one batch at a time (tree nodes, root exponents), reusable
+typedef struct FIAT_CTX FIAT_CTX;
+
+// Primes p, q with p-1 and q-1 coprime to every exponent; count <= FIAT_MAX_BATCH.
+// Returns 0 on success, -1 for bad arguments.
+int fiat_keyset_generate(FIAT_KEYSET *ks, int prime_bits, int count, gmp_randstate_t state);
+void fiat_keyset_clear(FIAT_KEYSET *ks);
+
+void fiat_encrypt(mpz_t c, const mpz_t m, const FIAT_KEYSET *ks, int i);   // c = m^e[i] mod N
+void fiat_decrypt(mpz_t m, const mpz_t c, const FIAT_KEYSET *ks, int i);   // single CRT
+
+FIAT_CTX *fiat_ctx_create(const FIAT_KEYSET *ks);
+void fiat_ctx_destroy(FIAT_CTX *ctx);
+
+// m[j] = c[j]^(1/e[idx[j]]) mod N for j < count, as one tree batch. The idx
+// values must be distinct; a single item, and any c[j] that is not a unit
+// mod N (0, a multiple of p or q), is decrypted on its own.
+// Returns 0, or -1 for a repeated or out-of-range index.
+int fiat_decrypt_batch(FIAT_CTX *ctx, mpz_t *m, mpz_t *c, const int *idx, int count);
+
+// Pending-decryption queue over one key set. min_batch <= 0 and
+// timeout_us < 0 take FIAT_MIN_BATCH and FIAT_TIMEOUT_US; min_batch is
+// capped at the number of exponents. The queue has no threads of its own:
+// the caller whose request fills a batch, or whose wait times out, runs it.
+typedef struct FIAT_QUEUE FIAT_QUEUE;
+
+FIAT_QUEUE *fiat_queue_create(const FIAT_KEYSET *ks, int min_batch, long timeout_us);
+void fiat_queue_destroy(FIAT_QUEUE *q);
+
+// m = c^(1/e[i]) mod N through the queue; blocks until the batch holding the
+// request is done. A second request for an exponent already pending waits
+// for the next batch. Returns 0, or -1 for an out-of-range i.
+int fiat_queue_decrypt(FIAT_QUEUE *q, mpz_t m, const mpz_t c, int i);
+
+#endif /* RSA_FIAT_H */
@@ -0,0 +1,180 @@
+// rsa_key.c
+// RSA key generation and textbook encrypt/decrypt on GMP integers.
+
+#include <stdlib.h>
+
+#include "rsa_key.h"
+#include "prime_search.h"
+#include "rsa_batch.h"
+#include "montgomery.h"
+
+void rsa_key_init(RSA_KEY *key) {
+    key->prime_bits = 0;
+    key->mont = NULL;
+    mpz_inits(key->n, key->e, key->d, key->p, key->q,
+              key->dP, key->dQ, key->qInv, NULL);
+}
+
+void rsa_key_clear(RSA_KEY *key) {
+    mpz_clears(key->n, key->e, key->d, key->p, key->q,
+               key->dP, key->dQ, key->qInv, NULL);
+    free(key->mont);
+}
+
+int rsa_key_precompute(RSA_KEY *key) {
+    if (!key->mont && !(key->mont = malloc(3 * sizeof *key->mont))) return -1;
+    // a modulus the kernels do not cover keeps limbs == 0 (crypto_powm path)
+    mont_ctx_init(&key->mont[0], key->n);
+    mont_ctx_init(&key->mont[1], key->p);
+    mont_ctx_init(&key->mont[2], key->q);
+    return 0;
+}
+
+// Sieved incremental search: one primality pass per surviving candidate
+void rsa_generate_prime(mpz_t prime, gmp_randstate_t state, int bits) {
+    prime_search_random(prime, state, bits, 25);
+}
+
+int rsa_key_from_primes(RSA_KEY *key, const mpz_t p, const mpz_t q, const mpz_t e) {
+    if (mpz_cmp(p, q) == 0) return -1;
+
+    mpz_t phi, p1, q1;
+    mpz_inits(phi, p1, q1, NULL);
+
+    mpz_set(key->p, p);
+    mpz_set(key->q, q);
+    mpz_set(key->e, e);
+    mpz_mul(key->n, p, q);
+    key->prime_bits = (int)mpz_sizeinbase(p, 2);
+
+    mpz_sub_ui(p1, p, 1);
+    mpz_sub_ui(q1, q, 1);
+    mpz_mul(phi, p1, q1);
+
+    int rc = -1;
+    if (mpz_invert(key->d, e, phi) != 0 && mpz_invert(key->qInv, q, p) != 0) {
+        mpz_mod(key->dP, key->d, p1);
+        mpz_mod(key->dQ, key->d, q1);
+        rc = rsa_key_precompute(key);
+    }
+
+    mpz_clears(phi, p1, q1, NULL);
+    return rc;
+}
+
+int rsa_key_generate(RSA_KEY *key, int prime_bits, gmp_randstate_t state) {
+    if (prime_bits < 16) return -1;
+
+    mpz_t p, q, e;
+    mpz_inits(p, q, e, NULL);
+    mpz_set_ui(e, RSA_DEFAULT_E);
+
+    // e must be invertible mod phi(N); retry with new primes otherwise
+    do {
+        rsa_generate_prime(p, state, prime_bits);
+        rsa_generate_prime(q, state, prime_bits);
+    } while (rsa_key_from_primes(key, p, q, e) != 0);
+    key->prime_bits = prime_bits;
+
+    mpz_clears(p, q, e, NULL);
+    return 0;
+}
+
+void rsa_encrypt(mpz_t c, const mpz_t m, const RSA_KEY *key) {
+    if (mpz_cmp_ui(key->e, RSA_DEFAULT_E) == 0)
+        rsa_pow65537(c, m, key->n);         // fixed addition chain (rsa_batch.h)
+    else
+        mpz_powm(c, m, key->e, key->n);
+}
+
+void rsa_decrypt(mpz_t m, const mpz_t c, const RSA_KEY *key) {
+    crypto_powm_ctx(m, c, key->d, key->n, key->mont ? &key->mont[0] : NULL);
+}
+
+void rsa_decrypt_crt(mpz_t m, const mpz_t c, const RSA_KEY *key) {
+    mpz_t m1, m2;
+    mpz_init2(m1, mpz_sizeinbase(key->n, 2));
+    mpz_init2(m2, mpz_sizeinbase(key->n, 2));
+
+    const MONT_CTX *mp = key->mont ? &key->mont[1] : NULL;
+    const MONT_CTX *mq = key->mont ? &key->mont[2] : NULL;
+    crypto_powm_ctx(m1, c, key->dP, key->p, mp);   // m1 = c^dP mod p
+    crypto_powm_ctx(m2, c, key->dQ, key->q, mq);   // m2 = c^dQ mod q
+
+    mpz_sub(m1, m1, m2);                    // h = qInv * (m1 - m2) mod p
+    mpz_mul(m1, m1, key->qInv);
+    mpz_mod(m1, m1, key->p);
+
+    mpz_mul(m1, m1, key->q);                // m = m2 + h * q
+    mpz_add(m, m2, m1);
+
+    mpz_clears(m1, m2, NULL);
+}
+
+void rsa_blinding_init(RSA_BLINDING *b, const RSA_KEY *key, gmp_randstate_t state) {
+    mpz_init2(b->vf, mpz_sizeinbase(key->n, 2));
+    mpz_init2(b->vi, mpz_sizeinbase(key->n, 2));
+    // r must be a unit mod N; a factor of N shows up as a failed inversion
+    do {
+        mpz_urandomm(b->vi, state, key->n);
+    } while (mpz_cmp_ui(b->vi, 1) <= 0 || mpz_invert(b->vf, b->vi, key->n) == 0);
+    mpz_powm(b->vi, b->vi, key->e, key->n);     // vi = r^e
+    mpz_swap(b->vf, b->vi);                     // vf = r^e, vi = r^-1
+}
+
+void rsa_blinding_clear(RSA_BLINDING *b) {
+    mpz_clears(b->vf, b->vi, NULL);
+}
+
+void rsa_decrypt_ct(mpz_t m, const mpz_t c, const RSA_KEY *key, RSA_BLINDING *b) {
+    size_t nbits = mpz_sizeinbase(key->n, 2);
+    mpz_t cb, m1, m2;
+    mpz_init2(cb, 2 * nbits);
+    mpz_init2(m1, 2 * nbits);
+    mpz_init2(m2, 2 * nbits);
+
+    if (b) {
+        mpz_mul(cb, c, b->vf);                  // cb = c * r^e mod N
+        mpz_mod(cb, cb, key->n);
+    } else {
+        mpz_mod(cb, c, key->n);
+    }
+
+    mpz_mod(m1, cb, key->p);
+    mpz_powm_sec(m1, m1, key->dP, key->p);     // m1 = cb^dP mod p
+    mpz_mod(m2, cb, key->q);
+    mpz_powm_sec(m2, m2, key->dQ, key->q);     // m2 = cb^dQ mod q
+
+    mpz_sub(m1, m1, m2);                        // h = qInv * (m1 - m2) mod p
+    mpz_mul(m1, m1, key->qInv);
+    mpz_mod(m1, m1, key->p);
+    mpz_mul(m1, m1, key->q);                    // m' = m2 + h * q = (c r^e)^d = m r
+    mpz_add(cb, m2, m1);
+
+    if (b) {
+        mpz_mul(cb, cb, b->vi);                 // m = m' * r^-1 mod N
+        mpz_mod(m, cb, key->n);
+        // next call uses r^2: two squarings instead of a new r, r^e, r^-1
+        mpz_mul(cb, b->vf, b->vf);
+        mpz_mod(b->vf, cb, key->n);
+        mpz_mul(cb, b->vi, b->vi);
+        mpz_mod(b->vi, cb, key->n);
+    } else {
+        mpz_set(m, cb);
+    }
+
+    mpz_clears(cb, m1, m2, NULL);
+}
+
+void rsa_sign(mpz_t s, const mpz_t m, const RSA_KEY *key) {
+    rsa_decrypt_crt(s, m, key);
+}
+
+int rsa_verify(const mpz_t s, const mpz_t m, const RSA_KEY *key) {
+    mpz_t t;
+    mpz_init(t);
+    rsa_encrypt(t, s, key);
+    int ok = mpz_cmp(t, m) == 0;
+    mpz_clear(t);
+    return ok;
+}
@@ -0,0 +1,67 @@
+// rsa_key.h
+// Reusable RSA key pair and primitives shared by the RSA programs and the
+// benchmark driver. Sizes follow rsa_assignment_*.c: `prime_bits` is the size
+// of p and q, so the modulus N has 2 * prime_bits bits.
+
+#ifndef RSA_KEY_H
+#define RSA_KEY_H
+
+#include <gmp.h>
+#include "montgomery.h"
+
+#define RSA_DEFAULT_E 65537
+
+typedef struct {
+    int prime_bits;
+    mpz_t n, e, d;      // public modulus/exponent, private exponent
+    mpz_t p, q;         // prime factors of n
+    mpz_t dP, dQ;       // CRT exponents: d mod (p-1), d mod (q-1)
+    mpz_t qInv;         // q^-1 mod p (Garner recombination)
+    MONT_CTX *mont;     // contexts for n, p, q (rsa_key_precompute), NULL if not built
+} RSA_KEY;
+
+// Base blinding for the private-key operation: vf = r^e and vi = r^-1 mod N
+// for a random r. Both are squared after every use, which keeps them a
+// matching pair ((r^2)^e, r^-2) without a fresh inversion per call.
+// Not shared between threads: one per thread.
+typedef struct {
+    mpz_t vf, vi;
+} RSA_BLINDING;
+
+void rsa_key_init(RSA_KEY *key);
+void rsa_key_clear(RSA_KEY *key);
+
+// Random prime of exactly `bits` bits
+void rsa_generate_prime(mpz_t prime, gmp_randstate_t state, int bits);
+
+// Fresh p, q and d = e^-1 mod phi(N) with e = 65537; returns 0 on success
+int rsa_key_generate(RSA_KEY *key, int prime_bits, gmp_randstate_t state);
+
+// Full private key (n, d, dP, dQ, qInv) from given primes and public exponent;
+// returns -1 if e is not invertible mod phi(N) or p == q
+int rsa_key_from_primes(RSA_KEY *key, const mpz_t p, const mpz_t q, const mpz_t e);
+
+// (Re)builds the Montgomery contexts for n, p and q once, so every private-key
+// operation with this key skips n^-1 and R^2 mod n. Called by
+// rsa_key_from_primes; needed again only after setting n, p or q by hand.
+// Returns 0, or -1 if the contexts could not be allocated.
+int rsa_key_precompute(RSA_KEY *key);
+
+void rsa_encrypt(mpz_t c, const mpz_t m, const RSA_KEY *key);   // c = m^e mod N
+void rsa_decrypt(mpz_t m, const mpz_t c, const RSA_KEY *key);   // m = c^d mod N
+
+// CRT private-key operation: two half-size exponentiations mod p and q,
+// recombined with Garner's formula  m = m2 + q * (qInv * (m1 - m2) mod p)
+void rsa_decrypt_crt(mpz_t m, const mpz_t c, const RSA_KEY *key);
+void rsa_sign(mpz_t s, const mpz_t m, const RSA_KEY *key);      // s = m^d mod N via CRT
+int  rsa_verify(const mpz_t s, const mpz_t m, const RSA_KEY *key);  // 1 if s^e == m
+
+void rsa_blinding_init(RSA_BLINDING *b, const RSA_KEY *key, gmp_randstate_t state);
+void rsa_blinding_clear(RSA_BLINDING *b);
+
+// Side-channel hardened private-key operation: CRT with mpz_powm_sec (fixed
+// window, no secret-dependent branches or memory access) on the blinded base
+// c * r^e; the result is unblinded with r^-1. b may be NULL (no blinding).
+void rsa_decrypt_ct(mpz_t m, const mpz_t c, const RSA_KEY *key, RSA_BLINDING *b);
+
+#endif /* RSA_KEY_H */
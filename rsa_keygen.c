@@ -0,0 +1,204 @@
+/*
+Parallel RSA key generation (see rsa_keygen.h) plus a scaling benchmark.
+
+To compile:
+    make rsa_keygen
+
+To run:
+    ./build/bin/rsa_keygen [prime_bits=512] [keys=200] [max_threads=nproc]
+
+Prints keys/second for 1, 2, 4, ... max_threads workers.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include <gmp.h>
+
+#include "rsa_keygen.h"
+#include "worker_pool.h"
+#include "prime_search.h"
+#include "cycle_timer.h"
+
+typedef struct {
+    RSA_KEYGEN *kg;
+    int id;
+    gmp_randstate_t rng;
+    mpz_t cand;
+    PRIME_SEARCH search;
+} KG_WORKER;
+
+struct RSA_KEYGEN {
+    WORKER_POOL pool;
+    KG_WORKER *workers;
+
+    // current request
+    int prime_bits;
+    pthread_mutex_t mu;         // guards prime[] and found
+    mpz_t prime[2];
+    int found;
+    atomic_int cancel;          // polled between candidates
+};
+
+/* Offers a prime to the current request; returns 1 once p and q are both taken */
+static int kg_offer(RSA_KEYGEN *kg, const mpz_t prime) {
+    pthread_mutex_lock(&kg->mu);
+    if (kg->found < 2 && (kg->found == 0 || mpz_cmp(kg->prime[0], prime) != 0))
+        mpz_set(kg->prime[kg->found++], prime);
+    int done = kg->found == 2;
+    if (done) atomic_store(&kg->cancel, 1);
+    pthread_mutex_unlock(&kg->mu);
+    return done;
+}
+
+/* Sieved incremental search from a random start (prime_search.h); the cancel
+   flag is polled before every surviving candidate, so a cancelled worker
+   stops after at most one primality test. */
+static void kg_search(KG_WORKER *w, int bits) {
+    RSA_KEYGEN *kg = w->kg;
+    while (!atomic_load_explicit(&kg->cancel, memory_order_relaxed)) {
+        mpz_urandomb(w->cand, w->rng, bits);
+        mpz_setbit(w->cand, bits - 1);
+        prime_search_start(&w->search, w->cand);
+        // a fresh random start after every prime keeps p and q independent
+        if (prime_search_find(&w->search, w->cand, 25, bits, &kg->cancel)
+            && kg_offer(kg, w->cand))
+            return;
+    }
+}
+
+static void kg_job(void *arg, int id) {
+    RSA_KEYGEN *kg = arg;
+    kg_search(&kg->workers[id], kg->prime_bits);
+}
+
+static void kg_worker_clear(KG_WORKER *w) {
+    mpz_clear(w->cand);
+    prime_search_clear(&w->search);
+    gmp_randclear(w->rng);
+}
+
+RSA_KEYGEN *rsa_keygen_create(int threads, unsigned long seed) {
+    threads = worker_pool_size(threads);
+    RSA_KEYGEN *kg = calloc(1, sizeof *kg);
+    if (!kg) return NULL;
+    kg->workers = calloc((size_t)threads, sizeof *kg->workers);
+    if (!kg->workers) { free(kg); return NULL; }
+    pthread_mutex_init(&kg->mu, NULL);
+    mpz_inits(kg->prime[0], kg->prime[1], NULL);
+    atomic_init(&kg->cancel, 0);
+
+    for (int i = 0; i < threads; i++) {
+        KG_WORKER *w = &kg->workers[i];
+        w->kg = kg;
+        w->id = i;
+        gmp_randinit_mt(w->rng);
+        gmp_randseed_ui(w->rng, seed + 0x9E3779B97F4A7C15ul * (unsigned long)(i + 1));
+        mpz_init(w->cand);
+        prime_search_init(&w->search);
+    }
+    // each worker races for p and q on its own, so fewer of them only slows it
+    int started = worker_pool_start(&kg->pool, threads, kg_job, kg);
+    for (int i = started; i < threads; i++) kg_worker_clear(&kg->workers[i]);
+    if (started == 0) {
+        mpz_clears(kg->prime[0], kg->prime[1], NULL);
+        pthread_mutex_destroy(&kg->mu);
+        free(kg->workers);
+        free(kg);
+        return NULL;
+    }
+    return kg;
+}
+
+void rsa_keygen_destroy(RSA_KEYGEN *kg) {
+    if (!kg) return;
+    int n = kg->pool.nthreads;
+    worker_pool_stop(&kg->pool);
+    for (int i = 0; i < n; i++) kg_worker_clear(&kg->workers[i]);
+    mpz_clears(kg->prime[0], kg->prime[1], NULL);
+    pthread_mutex_destroy(&kg->mu);
+    free(kg->workers);
+    free(kg);
+}
+
+int rsa_keygen_threads(const RSA_KEYGEN *kg) {
+    return kg->pool.nthreads;
+}
+
+int rsa_keygen_primes(RSA_KEYGEN *kg, mpz_t p, mpz_t q, int prime_bits) {
+    if (prime_bits < 16) return -1;
+
+    kg->prime_bits = prime_bits;
+    kg->found = 0;
+    atomic_store(&kg->cancel, 0);
+    worker_pool_run(&kg->pool);
+    mpz_set(p, kg->prime[0]);
+    mpz_set(q, kg->prime[1]);
+    return 0;
+}
+
+int rsa_keygen_next(RSA_KEYGEN *kg, RSA_KEY *key, int prime_bits) {
+    mpz_t p, q, e;
+    mpz_inits(p, q, e, NULL);
+    mpz_set_ui(e, RSA_DEFAULT_E);
+
+    int rc;
+    do {
+        rc = rsa_keygen_primes(kg, p, q, prime_bits);
+    } while (rc == 0 && rsa_key_from_primes(key, p, q, e) != 0);
+
+    mpz_clears(p, q, e, NULL);
+    return rc;
+}
+
+/* ---- Scaling benchmark ---- */
+
+#ifndef CRYPTO_NO_MAIN
+int main(int argc, char **argv) {
+    int bits     = argc > 1 ? atoi(argv[1]) : 512;
+    int keys     = argc > 2 ? atoi(argv[2]) : 200;
+    int max_thr  = argc > 3 ? atoi(argv[3]) : (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (bits < 16 || keys < 1 || max_thr < 1) {
+        fprintf(stderr, "Usage: %s [prime_bits] [keys] [max_threads]\n", argv[0]);
+        return 1;
+    }
+
+    ct_init();
+    RSA_KEY key;
+    rsa_key_init(&key);
+
+    printf("RSA key generation, %d-bit primes, %d keys per run\n", bits, keys);
+    printf("%8s %12s %12s %10s\n", "threads", "seconds", "keys/s", "speedup");
+
+    double base = 0.0;
+    for (int t = 1; ; t = (t * 2 > max_thr && t < max_thr) ? max_thr : t * 2) {
+        RSA_KEYGEN *kg = rsa_keygen_create(t, 0xC0FFEEul);
+        if (!kg) return 1;
+
+        CT_STATS stats;
+        ct_stats_reset(&stats);
+        uint64_t t0 = ct_start();
+        for (int i = 0; i < keys; i++) {
+            uint64_t k0 = ct_start();
+            rsa_keygen_next(kg, &key, bits);
+            ct_stats_add(&stats, ct_elapsed(k0, ct_stop()));
+        }
+        double secs = ct_to_ns((double)ct_elapsed(t0, ct_stop())) * 1e-9;
+        rsa_keygen_destroy(kg);
+
+        double rate = keys / secs;
+        if (t == 1) base = rate;
+        printf("%8d %12.3f %12.2f %9.2fx\n", t, secs, rate, rate / base);
+
+        char variant[16];
+        snprintf(variant, sizeof variant, "t%d", t);
+        ct_csv_report("rsa_keygen", variant, (size_t)bits, &stats, NULL);
+        if (t >= max_thr) break;
+    }
+
+    rsa_key_clear(&key);
+    return 0;
+}
+#endif /* CRYPTO_NO_MAIN */
@@ -0,0 +1,30 @@
+// rsa_keygen.h
+// Multithreaded RSA key-generation service.
+//
+// A pool of worker threads, each with its own Mersenne Twister stream,
+// searches for primes concurrently. The first two distinct primes found
+// become p and q; the remaining searches are cancelled between candidates,
+// and the pool goes back to sleep until the next request.
+
+#ifndef RSA_KEYGEN_H
+#define RSA_KEYGEN_H
+
+#include "rsa_key.h"
+
+typedef struct RSA_KEYGEN RSA_KEYGEN;
+
+// threads <= 0 uses every online CPU; each worker seeds its RNG from seed + id.
+// If some threads cannot be started the pool keeps the ones that did
+// (rsa_keygen_threads); NULL if none start.
+RSA_KEYGEN *rsa_keygen_create(int threads, unsigned long seed);
+void rsa_keygen_destroy(RSA_KEYGEN *kg);
+int rsa_keygen_threads(const RSA_KEYGEN *kg);
+
+// Blocks until p and q are found, then fills key (e = 65537, CRT params included);
+// returns 0 on success, -1 for an unsupported size
+int rsa_keygen_next(RSA_KEYGEN *kg, RSA_KEY *key, int prime_bits);
+
+// Only the primes, for callers that time p/q generation separately
+int rsa_keygen_primes(RSA_KEYGEN *kg, mpz_t p, mpz_t q, int prime_bits);
+
+#endif /* RSA_KEYGEN_H */
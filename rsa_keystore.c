@@ -0,0 +1,223 @@
+// rsa_keystore.c
+// Memory-mapped RSA key store (see rsa_keystore.h).
+//
+// File layout, all fields native-endian and 8-byte aligned:
+//   KS_HEADER
+//   per key: KS_RECORD, then the limbs of n e d p q dP dQ qInv in that
+//            order, then R^2 mod n, p, q (mont_limbs[i] limbs each)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "rsa_keystore.h"
+
+#define KS_MAGIC   "RSAKEYS1"
+#define KS_FIELDS  8            // n e d p q dP dQ qInv
+#define KS_MONT    3            // n p q
+
+typedef struct {
+    char magic[8];
+    uint32_t limb_bits;         // GMP_NUMB_BITS of the writer
+    uint32_t count;
+} KS_HEADER;
+
+typedef struct {
+    uint32_t prime_bits;
+    uint32_t limbs[KS_FIELDS];
+    uint32_t mont_limbs[KS_MONT];   // kernel width, 0 = no Montgomery context
+    uint64_t mont_ninv[KS_MONT];
+} KS_RECORD;
+
+_Static_assert(sizeof(KS_HEADER) % 8 == 0, "limbs must stay 8-byte aligned");
+_Static_assert(sizeof(KS_RECORD) % 8 == 0, "limbs must stay 8-byte aligned");
+
+struct RSA_KEYSTORE {
+    void *map;
+    size_t len;
+    int count;
+    const KS_RECORD **rec;      // record headers, indexed once at open
+};
+
+/* Montgomery widths must be the kernel width of their modulus (or 0, no
+   context): rsa_keystore_get copies that many limbs into a MONT_CTX */
+static int ks_record_valid(const KS_RECORD *r) {
+    const uint32_t mod_limbs[KS_MONT] = {r->limbs[0], r->limbs[3], r->limbs[4]};
+    for (int m = 0; m < KS_MONT; m++)
+        if (r->mont_limbs[m] && (int)r->mont_limbs[m] != mont_width(mod_limbs[m]))
+            return 0;
+    return 1;
+}
+
+static size_t ks_record_limbs(const KS_RECORD *r) {
+    size_t n = 0;
+    for (int f = 0; f < KS_FIELDS; f++) n += r->limbs[f];
+    for (int m = 0; m < KS_MONT; m++) n += r->mont_limbs[m];
+    return n;
+}
+
+RSA_KEYSTORE *rsa_keystore_open(const char *path) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return NULL;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(KS_HEADER)) {
+        close(fd);
+        return NULL;
+    }
+    size_t len = (size_t)st.st_size;
+    void *map = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return NULL;
+
+    const KS_HEADER *h = map;
+    RSA_KEYSTORE *ks = calloc(1, sizeof *ks);
+    if (!ks || memcmp(h->magic, KS_MAGIC, 8) != 0 || h->limb_bits != GMP_NUMB_BITS)
+        goto fail;
+    ks->map = map;
+    ks->len = len;
+    // no more records than the file has room for, whatever the header says
+    size_t count = (len - sizeof *h) / sizeof(KS_RECORD);
+    if (h->count < count) count = h->count;
+    ks->rec = malloc((count ? count : 1) * sizeof *ks->rec);
+    if (!ks->rec) goto fail;
+
+    // walk the records once; a torn append at the tail is ignored, a record
+    // with impossible Montgomery widths rejects the whole file
+    size_t off = sizeof *h;
+    for (size_t i = 0; i < count; i++) {
+        if (off + sizeof(KS_RECORD) > len) break;
+        const KS_RECORD *r = (const KS_RECORD *)((const char *)map + off);
+        if (!ks_record_valid(r)) goto fail;
+        size_t next = off + sizeof *r + ks_record_limbs(r) * sizeof(mp_limb_t);
+        if (next > len) break;
+        ks->rec[ks->count++] = r;
+        off = next;
+    }
+    return ks;
+
+fail:
+    if (ks) free(ks->rec);
+    free(ks);
+    munmap(map, len);
+    return NULL;
+}
+
+void rsa_keystore_close(RSA_KEYSTORE *ks) {
+    if (!ks) return;
+    munmap(ks->map, ks->len);
+    free(ks->rec);
+    free(ks);
+}
+
+int rsa_keystore_count(const RSA_KEYSTORE *ks) {
+    return ks->count;
+}
+
+int rsa_keystore_find(const RSA_KEYSTORE *ks, int prime_bits) {
+    for (int i = 0; i < ks->count; i++)
+        if ((int)ks->rec[i]->prime_bits == prime_bits) return i;
+    return -1;
+}
+
+int rsa_keystore_get(const RSA_KEYSTORE *ks, int i, RSA_KEY *view, MONT_CTX mont[3]) {
+    if (i < 0 || i >= ks->count) return -1;
+    const KS_RECORD *r = ks->rec[i];
+    const mp_limb_t *lp = (const mp_limb_t *)(r + 1);
+
+    view->prime_bits = (int)r->prime_bits;
+    view->mont = mont;
+    mpz_ptr field[KS_FIELDS] = {view->n, view->e, view->d, view->p, view->q,
+                                view->dP, view->dQ, view->qInv};
+    for (int f = 0; f < KS_FIELDS; f++) {
+        mpz_roinit_n(field[f], lp, (mp_size_t)r->limbs[f]);
+        lp += r->limbs[f];
+    }
+
+    // Montgomery contexts: modulus limbs from the key, constants from the file
+    const mp_limb_t *mod[KS_MONT] = {mpz_limbs_read(view->n), mpz_limbs_read(view->p),
+                                     mpz_limbs_read(view->q)};
+    const uint32_t mod_limbs[KS_MONT] = {r->limbs[0], r->limbs[3], r->limbs[4]};
+    for (int m = 0; m < KS_MONT; m++) {
+        if (mont) {
+            mont[m].limbs = (int)r->mont_limbs[m];
+            mont[m].ninv = r->mont_ninv[m];
+            memset(mont[m].n, 0, sizeof mont[m].n);
+            memset(mont[m].r2, 0, sizeof mont[m].r2);
+            if (r->mont_limbs[m]) {
+                memcpy(mont[m].n, mod[m], mod_limbs[m] * sizeof(mp_limb_t));
+                memcpy(mont[m].r2, lp, r->mont_limbs[m] * sizeof(mp_limb_t));
+            }
+        }
+        lp += r->mont_limbs[m];
+    }
+    return 0;
+}
+
+int rsa_keystore_append(const char *path, const RSA_KEY *key) {
+    int fd = open(path, O_RDWR | O_CREAT, 0600);
+    if (fd < 0) return -1;
+
+    KS_HEADER h;
+    ssize_t got = pread(fd, &h, sizeof h, 0);
+    if (got == 0) {
+        memcpy(h.magic, KS_MAGIC, 8);
+        h.limb_bits = GMP_NUMB_BITS;
+        h.count = 0;
+    } else if (got != (ssize_t)sizeof h || memcmp(h.magic, KS_MAGIC, 8) != 0
+               || h.limb_bits != GMP_NUMB_BITS) {
+        close(fd);
+        return -1;
+    }
+
+    KS_RECORD r;
+    memset(&r, 0, sizeof r);
+    r.prime_bits = (uint32_t)key->prime_bits;
+    mpz_srcptr field[KS_FIELDS] = {key->n, key->e, key->d, key->p, key->q,
+                                   key->dP, key->dQ, key->qInv};
+    for (int f = 0; f < KS_FIELDS; f++) r.limbs[f] = (uint32_t)mpz_size(field[f]);
+
+    MONT_CTX mont[KS_MONT];
+    mpz_srcptr mod[KS_MONT] = {key->n, key->p, key->q};
+    for (int m = 0; m < KS_MONT; m++) {
+        if (mont_ctx_init(&mont[m], mod[m]) == 0) {
+            r.mont_limbs[m] = (uint32_t)mont[m].limbs;
+            r.mont_ninv[m] = mont[m].ninv;
+        }
+    }
+
+    // append after the last published record (drops a torn earlier append),
+    // then publish the new one by bumping the count
+    off_t end = (off_t)sizeof h;
+    for (uint32_t i = 0; i < h.count; i++) {
+        KS_RECORD prev;
+        if (pread(fd, &prev, sizeof prev, end) != (ssize_t)sizeof prev) {
+            close(fd);
+            return -1;
+        }
+        end += (off_t)(sizeof prev + ks_record_limbs(&prev) * sizeof(mp_limb_t));
+    }
+    int rc = -1;
+    if (pwrite(fd, &r, sizeof r, end) == (ssize_t)sizeof r) {
+        off_t off = end + (off_t)sizeof r;
+        int ok = 1;
+        for (int f = 0; f < KS_FIELDS && ok; f++) {
+            size_t bytes = r.limbs[f] * sizeof(mp_limb_t);
+            ok = pwrite(fd, mpz_limbs_read(field[f]), bytes, off) == (ssize_t)bytes;
+            off += (off_t)bytes;
+        }
+        for (int m = 0; m < KS_MONT && ok; m++) {
+            size_t bytes = r.mont_limbs[m] * sizeof(mp_limb_t);
+            ok = pwrite(fd, mont[m].r2, bytes, off) == (ssize_t)bytes;
+            off += (off_t)bytes;
+        }
+        h.count++;
+        if (ok && pwrite(fd, &h, sizeof h, 0) == (ssize_t)sizeof h) rc = 0;
+    }
+    close(fd);
+    return rc;
+}
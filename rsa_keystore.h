@@ -0,0 +1,40 @@
+// rsa_keystore.h
+// Persistent RSA key store.
+//
+// A key file holds RSA_KEYs as raw GMP limbs (n, e, d, p, q and the CRT
+// parameters dP, dQ, qInv) together with the Montgomery constants (-m^-1 mod
+// 2^64, R^2 mod m) for n, p and q. The file is mapped read-only and keys are
+// handed out as views: their mpz_t fields point straight into the mapping
+// through mpz_roinit_n, so loading a key copies nothing and allocates
+// nothing. Views are read-only, stay valid until the store is closed, and
+// must not be passed to rsa_key_clear or any function that writes the key.
+
+#ifndef RSA_KEYSTORE_H
+#define RSA_KEYSTORE_H
+
+#include "rsa_key.h"
+#include "montgomery.h"
+
+typedef struct RSA_KEYSTORE RSA_KEYSTORE;
+
+// Maps an existing key file; NULL if it is missing, truncated, written
+// with a different limb size, or holds a record whose Montgomery widths
+// do not match its moduli
+RSA_KEYSTORE *rsa_keystore_open(const char *path);
+void rsa_keystore_close(RSA_KEYSTORE *ks);
+int rsa_keystore_count(const RSA_KEYSTORE *ks);
+
+// Read-only view of key i. mont (may be NULL) receives the stored contexts
+// for n, p and q and becomes view->mont, so the view decrypts without
+// rebuilding them; a context with limbs == 0 means that modulus is wider
+// than the Montgomery kernels. Returns 0, or -1 if i is out of range.
+int rsa_keystore_get(const RSA_KEYSTORE *ks, int i, RSA_KEY *view, MONT_CTX mont[3]);
+
+// Index of the first key with the given prime size, -1 if there is none
+int rsa_keystore_find(const RSA_KEYSTORE *ks, int prime_bits);
+
+// Appends a key to the file, creating it if needed. Stores already open see
+// the new key only after being reopened. Returns 0, or -1 on I/O error.
+int rsa_keystore_append(const char *path, const RSA_KEY *key);
+
+#endif /* RSA_KEYSTORE_H */
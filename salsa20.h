@@ -0,0 +1,11 @@
+// salsa20.h
+// Salsa20/20 core (salsha20.c): 64-byte block hash with feedforward.
+
+#ifndef SALSA20_H
+#define SALSA20_H
+
+#include <stdint.h>
+
+void salsa20_block(uint32_t out[16], const uint32_t in[16]);
+
+#endif /* SALSA20_H */
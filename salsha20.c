@@ -2,8 +2,9 @@
 #define _GNU_SOURCE
 #include <stdint.h>
 #include <stdio.h>
-#include <limits.h>
-#include <x86intrin.h>  // RDTSCP / LFENCE
+#include "salsa20.h"
+#include "multiversion.h"
+#include "cycle_timer.h"   // fenced RDTSC/RDTSCP, calibrated overhead
 
 /* 32-bit left rotate */
 static inline uint32_t ROTL32(uint32_t v, int n) {
@@ -19,6 +20,7 @@ static inline void QR(uint32_t *a, uint32_t *b, uint32_t *c, uint32_t *d) {
 }
 
 /* Salsa20 core block: out = Hash(in) where Hash is 20 rounds + feedforward */
+CRYPTO_KERNEL
 void salsa20_block(uint32_t out[16], const uint32_t in[16]) {
     uint32_t x[16];
     for (int i = 0; i < 16; ++i) x[i] = in[i];
@@ -40,41 +42,35 @@ void salsa20_block(uint32_t out[16], const uint32_t in[16]) {
     for (int i = 0; i < 16; ++i) out[i] = x[i] + in[i];
 }
 
-/* Get serialized timestamp counter using RDTSCP with LFENCE for ordering.
-   Returns 64-bit cycle count. */
-static inline unsigned long long timestamp(void) {
-    unsigned int aux;
-    _mm_lfence();               // serialize prior instructions
-    unsigned long long t = __rdtscp(&aux); // RDTSCP is serializing for later instructions
-    _mm_lfence();
-    return t;
-}
-
+#ifndef CRYPTO_NO_MAIN
 int main(void) {
     uint32_t in[16] = {0};   /* dummy input, as before */
     uint32_t out[16];
 
     const int runs = 100000;
-    unsigned long long min_cycles = ULLONG_MAX;
-    unsigned long long max_cycles = 0;
-    unsigned long long total_cycles = 0;
+    CT_STATS stats;
+    CT_PERF perf;
 
+    ct_init();
+    ct_stats_reset(&stats);
+    ct_perf_open(&perf);    /* optional: cycles/instructions/cache misses */
+    ct_perf_begin(&perf);
     for (int i = 0; i < runs; ++i) {
-        unsigned long long start = timestamp();
+        uint64_t start = ct_start();
         salsa20_block(out, in);
-        unsigned long long end = timestamp();
-        unsigned long long elapsed = end - start;
-
-        if (elapsed < min_cycles) min_cycles = elapsed;
-        if (elapsed > max_cycles) max_cycles = elapsed;
-        total_cycles += elapsed;
+        uint64_t end = ct_stop();
+        ct_stats_add(&stats, ct_elapsed(start, end));
     }
+    ct_perf_end(&perf);
 
-    double avg_cycles = (double)total_cycles / (double)runs;
+    double avg_cycles = ct_stats_avg(&stats);
     printf("Average cycles per run: %.2f\n", avg_cycles);
-    printf("Minimum cycles: %llu\n", (unsigned long long)min_cycles);
-    printf("Maximum cycles: %llu\n", (unsigned long long)max_cycles);
+    printf("Minimum cycles: %llu\n", (unsigned long long)stats.min);
+    printf("Maximum cycles: %llu\n", (unsigned long long)stats.max);
+    ct_csv_report("salsa20", "block", 64, &stats, &perf);
+    ct_perf_close(&perf);
 
     (void)out; /* silence unused-variable warnings if any */
     return 0;
 }
+#endif /* CRYPTO_NO_MAIN */
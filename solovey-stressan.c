@@ -1,72 +1,192 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <gmp.h>
+#include "primality.h"
+#include "prime_search.h"
+#include "montgomery.h"
+#include "trial_div.h"
 #include <time.h>
-#include <x86intrin.h>   // For __rdtsc()
+#include "cycle_timer.h"  // Shared calibrated cycle counter
 
-// Always-inline Jacobi
+// Always-inline modular exponentiation (GMP or fixed-width Montgomery, montgomery.h);
+// ctx is built once per n and shared by all k rounds
 static inline __attribute__((always_inline))
-int jacobi_symbol(const mpz_t a, const mpz_t n) {
-    return mpz_jacobi(a, n);
-}
-
-// Always-inline modular exponentiation
-static inline __attribute__((always_inline))
-void mod_exp(mpz_t result, const mpz_t base, const mpz_t exp, const mpz_t mod) {
-    mpz_powm(result, base, exp, mod);
+void mod_exp(mpz_t result, const mpz_t base, const mpz_t exp, const mpz_t mod,
+             const MONT_CTX *ctx) {
+    crypto_powm_ctx(result, base, exp, mod, ctx);
 }
 
 // Solovay–Strassen test
-int solovay_strassen(const mpz_t n, int k, gmp_randstate_t rng) {
+int solovay_strassen_ctx(const mpz_t n, int k, gmp_randstate_t rng, PRIMALITY_CTX *c) {
     // Handle small numbers explicitly
     if (mpz_cmp_ui(n, 2) < 0) return 0;          // n < 2 → composite
     if (mpz_cmp_ui(n, 2) == 0) return 1;         // 2 → prime
     if (mpz_cmp_ui(n, 3) == 0) return 1;         // 3 → prime
     if (mpz_even_p(n)) return 0;                 // even > 2 → composite
+    if (u64_dispatch_enabled && mpz_size(n) == 1)
+        return miller_rabin_u64(mpz_getlimbn(n, 0));   // proven, no GMP
+    if (trial_div_enabled && !trial_div_pass(n, c->t)) return 0;   // factor below 2^16
+
+    // Shorthands for the scratch integers; the Lucas slots hold the extra bases
+    mpz_ptr exp = c->d, n_minus1 = c->n_minus1, mod = c->x;
+    mpz_ptr base[MONT_MAX_BASES] = {c->a, c->U, c->V, c->Qk};
+    MONT_CTX ctx;
+    ctx.limbs = 0;
+    if (powm_backend == POWM_MONT) mont_ctx_init(&ctx, n);
+    int fused = ctx.limbs != 0;
+
+    mpz_sub_ui(n_minus1, n, 1);
+    mpz_fdiv_q_2exp(exp, n_minus1, 1);  // exp = (n-1)/2, once per n
+
+    for (int i = 0; i < k; ) {
+        // The first round runs alone since most composites fail it; later
+        // rounds go MONT_MAX_BASES at a time through one interleaved powm
+        int group = i == 0 || !fused ? 1 : k - i < MONT_MAX_BASES ? k - i : MONT_MAX_BASES;
+        int jacobi[MONT_MAX_BASES], sign[MONT_MAX_BASES];
+
+        for (int g = 0; g < group; g++) {
+            // Random base a ∈ [2, n-1]
+            mpz_urandomm(base[g], rng, n);
+            if (mpz_cmp_ui(base[g], 2) < 0) mpz_add_ui(base[g], base[g], 2);
+            jacobi[g] = jacobi_symbol(base[g], n);   // (a/n)
+            if (jacobi[g] == 0) return 0; // Composite
+        }
 
-    mpz_t a, exp, jac, mod;
-    mpz_inits(a, exp, jac, mod, NULL);
+        // a^((n-1)/2) mod n, compared against 1 and n-1 directly
+        if (fused) {
+            mont_ctx_powm_pm1(sign, (const mpz_srcptr *)base, group, exp, &ctx);
+        } else {
+            mod_exp(mod, base[0], exp, n, &ctx);
+            sign[0] = mpz_cmp_ui(mod, 1) == 0 ? 1 : mpz_cmp(mod, n_minus1) == 0 ? -1 : 0;
+        }
 
-    mpz_sub_ui(exp, n, 1);
-    mpz_fdiv_q_2exp(exp, exp, 1);  // exp = (n-1)/2
+        for (int g = 0; g < group; g++)
+            if (sign[g] != jacobi[g]) return 0; // Composite
+        i += group;
+    }
+    return 1; // Probably prime
+}
+
+int solovay_strassen(const mpz_t n, int k, gmp_randstate_t rng) {
+    PRIMALITY_CTX c;
+    primality_ctx_init(&c);
+    int prime = solovay_strassen_ctx(n, k, rng, &c);
+    primality_ctx_clear(&c);
+    return prime;
+}
+
+#ifndef CRYPTO_NO_MAIN
+// Generate a probable prime of given bits
+static void generate_prime(mpz_t prime, int bits, gmp_randstate_t rng) {
+    PRIME_SEARCH ps;
+    prime_search_init(&ps);
+    mpz_urandomb(prime, rng, bits);
+    mpz_setbit(prime, bits - 1);   // Ensure it's "bits"-bit
+    prime_search_start(&ps, prime);
+    prime_search_find(&ps, prime, 25, 0, NULL);   // Next prime, small primes sieved out
+    prime_search_clear(&ps);
+}
 
+/* The round loop before fusing: one base at a time, the Jacobi symbol
+   rebuilt as an mpz (1 or n-1) and compared with the powm result */
+static int ss_reference(const mpz_t n, int k, gmp_randstate_t rng, PRIMALITY_CTX *c) {
+    mpz_ptr a = c->a, exp = c->d, jac = c->n_minus1, mod = c->x;
+    MONT_CTX ctx;
+    ctx.limbs = 0;
+    if (powm_backend == POWM_MONT) mont_ctx_init(&ctx, n);
+    mpz_sub_ui(exp, n, 1);
+    mpz_fdiv_q_2exp(exp, exp, 1);
     for (int i = 0; i < k; i++) {
-        // Random base a ∈ [2, n-2]
         mpz_urandomm(a, rng, n);
         if (mpz_cmp_ui(a, 2) < 0) mpz_add_ui(a, a, 2);
-
-        // Compute jacobi = (a/n)
         int jacobi = jacobi_symbol(a, n);
-        if (jacobi == 0) {
-            mpz_clears(a, exp, jac, mod, NULL);
-            return 0; // Composite
-        }
-
-        // Compute mod = a^((n-1)/2) mod n
-        mod_exp(mod, a, exp, n);
-
-        // Bring Jacobi into same ring
+        if (jacobi == 0) return 0;
+        mod_exp(mod, a, exp, n, &ctx);
         if (jacobi == -1) mpz_sub_ui(jac, n, 1);
         else mpz_set_ui(jac, jacobi);
+        if (mpz_cmp(jac, mod) != 0) return 0;
+    }
+    return 1;
+}
+
+/* --bench: cycles per round on primes (every round runs), reference loop vs
+   the fused one; verdicts on primes, semiprimes and random odd numbers must
+   agree under both powm backends */
+static int ss_bench(int argc, char **argv) {
+    long count = argc > 0 ? atol(argv[0]) : 20;
+    int k = argc > 1 ? atoi(argv[1]) : 20;
+    if (count < 1 || k < 1) {
+        fprintf(stderr, "Usage: solovey-stressan --bench [count] [k]\n");
+        return 1;
+    }
 
-        if (mpz_cmp(jac, mod) != 0) {
-            mpz_clears(a, exp, jac, mod, NULL);
-            return 0; // Composite
+    static const int sizes[] = {512, 1024, 2048};
+    ct_init();
+    gmp_randstate_t rng;
+    gmp_randinit_mt(rng);
+    gmp_randseed_ui(rng, 0x55BE7C);
+    mpz_t n, q;
+    mpz_inits(n, q, NULL);
+    PRIMALITY_CTX c;
+    primality_ctx_init(&c);
+    int failed = 0;
+    POWM_BACKEND saved = powm_backend;
+    trial_div_enabled = 0;          // time the rounds, not the prefilter
+
+    printf("Solovay-Strassen, k=%d, cycles per round on primes\n", k);
+    printf("%6s %14s %14s %9s\n", "bits", "reference", "fused", "speedup");
+    for (size_t s = 0; s < sizeof sizes / sizeof sizes[0]; s++) {
+        int bits = sizes[s];
+        CT_STATS st_ref, st_fused;
+        ct_stats_reset(&st_ref);
+        ct_stats_reset(&st_fused);
+        for (long i = 0; i < count; i++) {
+            generate_prime(n, bits, rng);
+            uint64_t t0 = ct_start();
+            failed |= ss_reference(n, k, rng, &c) != 1;
+            ct_stats_add(&st_ref, ct_elapsed(t0, ct_stop()) / (uint64_t)k);
+            t0 = ct_start();
+            failed |= solovay_strassen_ctx(n, k, rng, &c) != 1;
+            ct_stats_add(&st_fused, ct_elapsed(t0, ct_stop()) / (uint64_t)k);
+        }
+        printf("%6d %14.0f %14.0f %8.2fx\n", bits, ct_stats_avg(&st_ref),
+               ct_stats_avg(&st_fused), ct_stats_avg(&st_ref) / ct_stats_avg(&st_fused));
+        ct_csv_report("solovay_strassen", "reference_round", (size_t)bits, &st_ref, NULL);
+        ct_csv_report("solovay_strassen", "fused_round", (size_t)bits, &st_fused, NULL);
+
+        // composites: semiprimes and random odd numbers, both backends
+        for (int backend = 0; backend < 2; backend++) {
+            powm_backend = backend ? POWM_GMP : saved;
+            for (long i = 0; i < count; i++) {
+                generate_prime(n, bits / 2, rng);
+                generate_prime(q, bits - bits / 2, rng);
+                mpz_mul(n, n, q);
+                failed |= solovay_strassen_ctx(n, k, rng, &c) != 0;
+                mpz_urandomb(n, rng, bits);
+                mpz_setbit(n, 0);
+                failed |= solovay_strassen_ctx(n, k, rng, &c) != (mpz_probab_prime_p(n, 25) != 0);
+            }
+            generate_prime(n, bits, rng);
+            failed |= solovay_strassen_ctx(n, k, rng, &c) != 1;
         }
+        powm_backend = saved;
     }
 
-    mpz_clears(a, exp, jac, mod, NULL);
-    return 1; // Probably prime
+    trial_div_enabled = 1;
+    printf("Result: %s\n", failed ? "MISMATCH" : "all verdicts match");
+    primality_ctx_clear(&c);
+    mpz_clears(n, q, NULL);
+    gmp_randclear(rng);
+    return failed;
 }
 
-// Generate a probable prime of given bits
-void generate_prime(mpz_t prime, int bits, gmp_randstate_t rng) {
-    mpz_urandomb(prime, rng, bits);
-    mpz_setbit(prime, bits - 1);   // Ensure it's "bits"-bit
-    mpz_nextprime(prime, prime);   // Next prime
-}
+int main(int argc, char **argv) {
+    if (argc > 1 && strcmp(argv[1], "--bench") == 0)
+        return ss_bench(argc - 2, argv + 2);
+    // the GMP cross-check repeats the test work, so it is opt-in
+    int gmp_cross_check = argc > 1 && strcmp(argv[1], "--gmp-check") == 0;
 
-int main() {
     mpz_t n;
     mpz_init(n);
     gmp_randstate_t rng;
@@ -90,17 +210,20 @@ int main() {
         mpz_set_str(n, input, 10);
     }
 
-    printf("Enter number of iterations k: ");
+    printf("Enter number of iterations k (0 = BPSW, no k needed): ");
     if (scanf("%d", &k) != 1) return 1;
 
-    unsigned long long start = __rdtsc();
-    int is_probably_prime = solovay_strassen(n, k, rng);
-    unsigned long long end = __rdtsc();
+    ct_init();
+    uint64_t start = ct_start();
+    int is_probably_prime = k > 0 ? solovay_strassen(n, k, rng) : bpsw(n);
+    uint64_t end = ct_stop();
 
-    unsigned long long total_cycles = end - start;
-    double avg_cycles = (k > 0) ? ((double) total_cycles / k) : 0.0;
+    unsigned long long total_cycles = ct_elapsed(start, end);
+    double avg_cycles = (k > 0) ? ((double) total_cycles / k) : (double) total_cycles;
 
-    if (is_probably_prime) {
+    if (is_probably_prime && k <= 0) {
+        printf("Result: PROBABLY PRIME (BPSW)\n");
+    } else if (is_probably_prime) {
         printf("Result: PROBABLY PRIME (k=%d, error ≤ 2^-%d)\n", k, k);
     } else {
         printf("Result: COMPOSITE\n");
@@ -109,13 +232,22 @@ int main() {
     printf("Total cycles: %llu\n", total_cycles);
     printf("Average cycles per iteration: %.2f\n", avg_cycles);
 
-    // Cross-check with GMP built-in test
-    int gmp_check = mpz_probab_prime_p(n, 25);
-    if (gmp_check == 0) printf("[GMP check] Definitely COMPOSITE\n");
-    else if (gmp_check == 1) printf("[GMP check] Probably PRIME\n");
-    else if (gmp_check == 2) printf("[GMP check] Definitely PRIME\n");
+    CT_STATS stats;
+    ct_stats_reset(&stats);
+    ct_stats_add(&stats, total_cycles);
+    ct_csv_report(k > 0 ? "solovay_strassen" : "bpsw", is_probably_prime ? "prime" : "composite",
+                  mpz_sizeinbase(n, 2), &stats, NULL);
+
+    // Cross-check with GMP built-in test (--gmp-check)
+    if (gmp_cross_check) {
+        int gmp_check = mpz_probab_prime_p(n, 25);
+        if (gmp_check == 0) printf("[GMP check] Definitely COMPOSITE\n");
+        else if (gmp_check == 1) printf("[GMP check] Probably PRIME\n");
+        else if (gmp_check == 2) printf("[GMP check] Definitely PRIME\n");
+    }
 
     mpz_clear(n);
     gmp_randclear(rng);
     return 0;
 }
+#endif /* CRYPTO_NO_MAIN */
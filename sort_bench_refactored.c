@@ -2,14 +2,15 @@
 Refactored sorting benchmark for WSL Ubuntu.
 
 To compile:
-    gcc -O2 -Wall sort_bench_refactored.c -o sort_bench_refactored -lm
+    gcc -O2 -Wall sort_bench_refactored.c cycle_timer.c -o sort_bench_refactored -lm
 
 To run:
     ./sort_bench_refactored
 
 Notes:
 - Produces console output similar to the original program and writes "benchmark_results.csv".
-- Uses a placeholder CPU frequency of 3e9 Hz for the clock_cycles column (same as original).
+- The clock_cycles column is measured with the shared cycle timer (cycle_timer.h);
+  set CT_CSV=<file> to also get rows in the common benchmark CSV schema.
 */
 
 #include <stdio.h>
@@ -17,6 +18,7 @@ Notes:
 #include <time.h>
 #include <stdbool.h>
 #include <math.h>
+#include "cycle_timer.h"
 
 /* ---- Types & prototypes ---- */
 
@@ -185,6 +187,97 @@ static void quick_sort_inst(int arr[], int n, long long *comparisons, long long
     quick_sort_rec(arr, 0, n - 1, comparisons, swaps);
 }
 
+/* Introsort: quicksort with a median-of-three pivot (ninther for large
+   ranges) and three-way partitioning, so runs of equal keys - common with
+   the 1..100 fill - are set aside in one pass instead of recursing on them.
+   Ranges of INTRO_CUTOFF or fewer go to insertion sort, and a range still
+   being split after 2*log2(n) levels is finished with heapsort. Recursing
+   only into the smaller side keeps the stack at O(log n). */
+#define INTRO_CUTOFF  16
+#define INTRO_NINTHER 128
+
+static void insertion_range_inst(int arr[], int low, int high, long long *comparisons, long long *swaps) {
+    for (int i = low + 1; i <= high; ++i) {
+        int key = arr[i];
+        int j = i - 1;
+        while (j >= low) {
+            (*comparisons)++;
+            if (arr[j] <= key) break;
+            arr[j + 1] = arr[j];
+            (*swaps)++;
+            --j;
+        }
+        arr[j + 1] = key;
+    }
+}
+
+/* index of the median of arr[a], arr[b], arr[c] */
+static int median3_inst(int arr[], int a, int b, int c, long long *comparisons) {
+    (*comparisons) += 2;
+    if (arr[a] < arr[b]) {
+        if (arr[b] < arr[c]) return b;
+        (*comparisons)++;
+        return arr[a] < arr[c] ? c : a;
+    }
+    if (arr[a] < arr[c]) return a;
+    (*comparisons)++;
+    return arr[b] < arr[c] ? c : b;
+}
+
+static void intro_sort_rec(int arr[], int low, int high, int depth, long long *comparisons, long long *swaps) {
+    while (high - low + 1 > INTRO_CUTOFF) {
+        int n = high - low + 1;
+        if (depth-- == 0) {
+            heap_sort_inst(arr + low, n, comparisons, swaps);
+            return;
+        }
+
+        int mid = low + n / 2;
+        int p;
+        if (n > INTRO_NINTHER) {
+            int s = n / 8;
+            p = median3_inst(arr,
+                             median3_inst(arr, low, low + s, low + 2 * s, comparisons),
+                             median3_inst(arr, mid - s, mid, mid + s, comparisons),
+                             median3_inst(arr, high - 2 * s, high - s, high, comparisons),
+                             comparisons);
+        } else {
+            p = median3_inst(arr, low, mid, high, comparisons);
+        }
+        int pivot = arr[p];
+
+        /* Dutch flag: [low, lt) < pivot, [lt, i) == pivot, (gt, high] > pivot */
+        int lt = low, i = low, gt = high;
+        while (i <= gt) {
+            (*comparisons)++;
+            if (arr[i] < pivot) {
+                swap_quick_inst(&arr[lt++], &arr[i++], swaps);
+            } else {
+                (*comparisons)++;
+                if (arr[i] > pivot)
+                    swap_quick_inst(&arr[i], &arr[gt--], swaps);
+                else
+                    ++i;
+            }
+        }
+
+        if (lt - low < high - gt) {
+            intro_sort_rec(arr, low, lt - 1, depth, comparisons, swaps);
+            low = gt + 1;
+        } else {
+            intro_sort_rec(arr, gt + 1, high, depth, comparisons, swaps);
+            high = lt - 1;
+        }
+    }
+    insertion_range_inst(arr, low, high, comparisons, swaps);
+}
+
+static void intro_sort_inst(int arr[], int n, long long *comparisons, long long *swaps) {
+    int depth = 0;
+    for (int m = n; m > 1; m >>= 1) depth += 2;
+    intro_sort_rec(arr, 0, n - 1, depth, comparisons, swaps);
+}
+
 /* ---- Benchmark runner ---- */
 
 static void run_benchmark(const char *name, SortFn fn, int size, int runs, double complexity, FILE *csv) {
@@ -203,13 +296,17 @@ static void run_benchmark(const char *name, SortFn fn, int size, int runs, doubl
     }
 
     long long total_cmp = 0, total_swp = 0;
+    CT_STATS stats;
+    ct_stats_reset(&stats);
 
     clock_t t0 = clock();
     for (int r = 0; r < runs; ++r) {
         for (int i = 0; i < size; ++i) workspace[i] = (rand() % 100) + 1;
 
         long long comps = 0, swaps = 0;
+        uint64_t c0 = ct_start();
         fn(workspace, size, &comps, &swaps);
+        ct_stats_add(&stats, ct_elapsed(c0, ct_stop()));
 
         cmp_runs[r] = comps;
         swp_runs[r] = swaps;
@@ -241,9 +338,10 @@ static void run_benchmark(const char *name, SortFn fn, int size, int runs, doubl
     printf("Avg swaps: %.2f\n", (double)total_swp / runs);
     printf("Min swaps: %lld, Max swaps: %lld, Median: %.2f\n", min_swp, max_swp, median_swp);
 
-    /* clock cycles placeholder using same 3e9 Hz as original */
-    double clock_speed_hz = 3e9;
-    double clock_cycles = cpu_time * clock_speed_hz;
+    /* measured sort cycles (array fill excluded), summed over all runs */
+    double clock_cycles = stats.total;
+    printf("Avg cycles per sort: %.2f\n", ct_stats_avg(&stats));
+    ct_csv_report("sort", name, (size_t)size, &stats, NULL);
 
     write_csv_line(csv, name, size, runs, cpu_time, clock_cycles,
                    (double)total_cmp / runs, (double)total_swp / runs, const_sort);
@@ -263,12 +361,14 @@ static void write_csv_line(FILE *csv, const char *name, int size, int runs, doub
 
 int main(void) {
     srand((unsigned)time(NULL));
+    ct_init();
 
     const SortEntry sorts[] = {
         {"Bubble Sort", bubble_sort_inst},
         {"Quick Sort", quick_sort_inst},
         {"Merge Sort", merge_sort_inst},
-        {"Heap Sort", heap_sort_inst}
+        {"Heap Sort", heap_sort_inst},
+        {"Introsort", intro_sort_inst}
     };
     const int sort_count = sizeof(sorts) / sizeof(sorts[0]);
 
@@ -286,7 +386,7 @@ int main(void) {
             double complexity;
             if (si == 0) { /* Bubble: n^2 */
                 complexity = pow((double)size, 2.0);
-            } else { /* Quick, Merge, Heap: n * log n */
+            } else { /* Quick, Merge, Heap, Intro: n * log n */
                 complexity = (double)size * log((double)size);
             }
             run_benchmark(sorts[si].name, sorts[si].fn, size, runs, complexity, csv);
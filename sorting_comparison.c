@@ -1,9 +1,9 @@
 /*
-Sorting benchmark: Bubble, Quick, Merge, Heap
+Sorting benchmark: Bubble, Quick, Merge, Heap, Intro
 Writes CSV: sorting_results.csv
 
 Compile (WSL Ubuntu):
-    gcc -O2 -Wall sorting_results.c -o sorting_results -lm
+    gcc -O2 -Wall sorting_results.c cycle_timer.c -o sorting_results -lm
 
 Run:
     ./sorting_results
@@ -13,6 +13,8 @@ CSV columns:
 
 Notes:
  - Uses rand() seeded by current time.
+ - Times only the sort call with the shared cycle timer (cycle_timer.h);
+   cpu_time_seconds is derived from the calibrated TSC frequency.
  - Runs = 1000 (change RUNS to adjust).
  - Array sizes 100..1000 step 100 (change MIN_SIZE/MAX_SIZE/STEP if desired).
 */
@@ -22,6 +24,7 @@ Notes:
 #include <time.h>
 #include <math.h>
 #include <string.h>
+#include "cycle_timer.h"
 
 #define MIN_SIZE 100
 #define MAX_SIZE 1000
@@ -161,6 +164,93 @@ void heap_sort_inst(int arr[], int n, Stats *s) {
     }
 }
 
+/* ---------- Introsort (instrumented) ---------- */
+/* Median-of-three / ninther pivot, three-way partition, insertion sort for
+   small ranges and a heapsort fallback after 2*log2(n) levels; see the
+   matching variant in sort_bench_refactored.c. */
+#define INTRO_CUTOFF  16
+#define INTRO_NINTHER 128
+
+static void insertion_range_q(int arr[], int low, int high, Stats *s) {
+    for (int i = low + 1; i <= high; ++i) {
+        int key = arr[i];
+        int j = i - 1;
+        while (j >= low) {
+            s->comparisons++;
+            if (arr[j] <= key) break;
+            arr[j + 1] = arr[j];
+            s->swaps++;
+            --j;
+        }
+        arr[j + 1] = key;
+    }
+}
+
+static int median3_q(int arr[], int a, int b, int c, Stats *s) {
+    s->comparisons += 2;
+    if (arr[a] < arr[b]) {
+        if (arr[b] < arr[c]) return b;
+        s->comparisons++;
+        return arr[a] < arr[c] ? c : a;
+    }
+    if (arr[a] < arr[c]) return a;
+    s->comparisons++;
+    return arr[b] < arr[c] ? c : b;
+}
+
+static void intro_sort_rec(int arr[], int low, int high, int depth, Stats *s) {
+    while (high - low + 1 > INTRO_CUTOFF) {
+        int n = high - low + 1;
+        if (depth-- == 0) {
+            heap_sort_inst(arr + low, n, s);
+            return;
+        }
+
+        int mid = low + n / 2;
+        int p;
+        if (n > INTRO_NINTHER) {
+            int k = n / 8;
+            p = median3_q(arr,
+                          median3_q(arr, low, low + k, low + 2 * k, s),
+                          median3_q(arr, mid - k, mid, mid + k, s),
+                          median3_q(arr, high - 2 * k, high - k, high, s), s);
+        } else {
+            p = median3_q(arr, low, mid, high, s);
+        }
+        int pivot = arr[p];
+
+        /* [low, lt) < pivot, [lt, i) == pivot, (gt, high] > pivot */
+        int lt = low, i = low, gt = high;
+        while (i <= gt) {
+            s->comparisons++;
+            if (arr[i] < pivot) {
+                swap_q(&arr[lt++], &arr[i++], s);
+            } else {
+                s->comparisons++;
+                if (arr[i] > pivot)
+                    swap_q(&arr[i], &arr[gt--], s);
+                else
+                    ++i;
+            }
+        }
+
+        if (lt - low < high - gt) {
+            intro_sort_rec(arr, low, lt - 1, depth, s);
+            low = gt + 1;
+        } else {
+            intro_sort_rec(arr, gt + 1, high, depth, s);
+            high = lt - 1;
+        }
+    }
+    insertion_range_q(arr, low, high, s);
+}
+
+void intro_sort_inst(int arr[], int n, Stats *s) {
+    int depth = 0;
+    for (int m = n; m > 1; m >>= 1) depth += 2;
+    intro_sort_rec(arr, 0, n - 1, depth, s);
+}
+
 /* ---------- Runner & CSV ---------- */
 
 typedef void (*SortFn)(int[], int, Stats *);
@@ -176,32 +266,36 @@ void run_and_record(FILE *csv, const char *name, SortFn fn, int size) {
 
     long long total_comps = 0;
     long long total_swaps = 0;
+    CT_STATS stats;
+    ct_stats_reset(&stats);
 
-    clock_t t0 = clock();
     for (int r = 0; r < RUNS; ++r) {
         fill_random(buffer, size);
         memcpy(work, buffer, sizeof(int) * size);
 
         Stats s = {0,0};
+        uint64_t c0 = ct_start();
         fn(work, size, &s);
+        ct_stats_add(&stats, ct_elapsed(c0, ct_stop()));
 
         total_comps += s.comparisons;
         total_swaps += s.swaps;
     }
-    clock_t t1 = clock();
 
-    double cpu_time = (double)(t1 - t0) / CLOCKS_PER_SEC;
+    double cpu_time = stats.total / ct_hz();
     double avg_comps = total_comps / (double)RUNS;
     double avg_swaps = total_swaps / (double)RUNS;
 
     fprintf(csv, "%s,%d,%d,%.6f,%.2f,%.2f\n",
             name, size, RUNS, cpu_time, avg_comps, avg_swaps);
+    ct_csv_report("sort", name, (size_t)size, &stats, NULL);
 
     free(buffer); free(work);
 }
 
 int main(void) {
     srand((unsigned)time(NULL));
+    ct_init();
 
     FILE *csv = fopen("sorting_results.csv", "w");
     if (!csv) {
@@ -217,6 +311,7 @@ int main(void) {
         run_and_record(csv, "Quick", quick_sort_inst, size);
         run_and_record(csv, "Merge", merge_sort_inst, size);
         run_and_record(csv, "Heap", heap_sort_inst, size);
+        run_and_record(csv, "Intro", intro_sort_inst, size);
         /* flush per-size so partial results are saved if interrupted */
         fflush(csv);
     }
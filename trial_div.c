@@ -0,0 +1,171 @@
+/*
+Small-prime product prefilter (see trial_div.h) plus a benchmark.
+
+To compile:
+    make trial_div
+
+To run:
+    ./build/bin/trial_div [count=2000]
+
+For random odd 512/1024/2048-bit candidates, prints cycles per candidate for
+miller_rabin and solovay_strassen (k = 25) with and without the prefilter;
+exits non-zero if any verdict changes.
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <gmp.h>
+
+#include "trial_div.h"
+#include "prime_sieve.h"
+#include "primality.h"
+#include "cycle_timer.h"
+
+#define TD_TIER0_LIMIT 50u      // 3 * 5 * ... * 47 < 2^64
+#define TD_TIER1_LIMIT 1024u
+#define TD_NPRIMES 6541         // odd primes below TD_LIMIT
+
+int trial_div_enabled = 1;
+
+static uint64_t td_bits[TD_LIMIT / 128];  // bit n/2 set for odd primes n < TD_LIMIT
+static unsigned long tier0;     // product of the primes 3..47
+static mpz_t tier1, tier2;      // 53..1021, 1031..65521
+static pthread_once_t tables_once = PTHREAD_ONCE_INIT;
+
+static void build_tables(void) {
+    tier0 = 1;
+    mpz_init_set_ui(tier1, 1);
+    mpz_init_set_ui(tier2, 1);
+    uint32_t prime[TD_NPRIMES];
+    size_t n = prime_sieve_fill(prime, TD_NPRIMES, 3, TD_LIMIT);
+    for (size_t k = 0; k < n; k++) {
+        uint32_t i = prime[k];
+        td_bits[i / 128] |= 1ull << (i / 2 % 64);
+        if (i < TD_TIER0_LIMIT)      tier0 *= i;
+        else if (i < TD_TIER1_LIMIT) mpz_mul_ui(tier1, tier1, i);
+        else                         mpz_mul_ui(tier2, tier2, i);
+    }
+}
+
+void trial_div_init(void) {
+    pthread_once(&tables_once, build_tables);
+}
+
+int trial_div_pass(const mpz_t n, mpz_ptr tmp) {
+    pthread_once(&tables_once, build_tables);
+
+    // a small factor rejects n unless n is itself one of the small primes
+    unsigned long v = mpz_get_ui(n);
+    int small = mpz_cmp_ui(n, TD_LIMIT) < 0 && (td_bits[v / 128] >> (v / 2 % 64) & 1);
+    if (mpz_gcd_ui(NULL, n, tier0) != 1) return small;
+
+    mpz_t own;
+    mpz_ptr t = tmp;
+    if (!t) {
+        mpz_init(own);
+        t = own;
+    }
+    mpz_gcd(t, n, tier1);
+    int pass = mpz_cmp_ui(t, 1) == 0;
+    if (pass) {
+        mpz_gcd(t, n, tier2);
+        pass = mpz_cmp_ui(t, 1) == 0;
+    }
+    if (!tmp) mpz_clear(own);
+    return pass || small;
+}
+
+/* ---- Benchmark: primality tests with and without the prefilter ---- */
+
+#ifndef CRYPTO_NO_MAIN
+int main(int argc, char **argv) {
+    long count = argc > 1 ? atol(argv[1]) : 2000;
+    if (count < 1) {
+        fprintf(stderr, "Usage: %s [count]\n", argv[0]);
+        return 1;
+    }
+
+    static const int sizes[] = {512, 1024, 2048};
+    typedef int (*TEST_FN)(const mpz_t, int, gmp_randstate_t);
+    static const struct { const char *name; TEST_FN fn; } tests[] = {
+        {"miller_rabin", miller_rabin},
+        {"solovay_strassen", solovay_strassen},
+    };
+
+    ct_init();
+    gmp_randstate_t rng;
+    gmp_randinit_mt(rng);
+    gmp_randseed_ui(rng, 0x7D1Ful);
+    int failed = 0;
+
+    printf("%-17s %6s %14s %14s %9s %8s\n", "test", "bits", "no filter", "prefilter",
+           "speedup", "primes");
+    for (size_t s = 0; s < sizeof sizes / sizeof sizes[0]; s++) {
+        int bits = sizes[s];
+        long reps = count * 512 / bits;
+        mpz_t *cand = malloc((size_t)reps * sizeof *cand);
+        for (long i = 0; i < reps; i++) {
+            mpz_init(cand[i]);
+            mpz_urandomb(cand[i], rng, bits);
+            mpz_setbit(cand[i], bits - 1);
+            mpz_setbit(cand[i], 0);
+        }
+
+        for (size_t t = 0; t < sizeof tests / sizeof tests[0]; t++) {
+            CT_STATS st[2];
+            long primes = 0;
+            for (int on = 0; on < 2; on++) {
+                ct_stats_reset(&st[on]);
+                trial_div_enabled = on;
+                for (long i = 0; i < reps; i++) {
+                    uint64_t t0 = ct_start();
+                    int v = tests[t].fn(cand[i], 25, rng);
+                    ct_stats_add(&st[on], ct_elapsed(t0, ct_stop()));
+                    // a composite may pass with probability <= 2^-25; a prime never fails
+                    if (on) failed |= v != (mpz_probab_prime_p(cand[i], 25) != 0);
+                    primes += on && v;
+                }
+            }
+            trial_div_enabled = 1;
+
+            printf("%-17s %6d %14.0f %14.0f %8.2fx %8ld\n", tests[t].name, bits,
+                   ct_stats_avg(&st[0]), ct_stats_avg(&st[1]),
+                   ct_stats_avg(&st[0]) / ct_stats_avg(&st[1]), primes);
+            ct_csv_report("trial_div", tests[t].name, (size_t)bits, &st[1], NULL);
+        }
+
+        for (long i = 0; i < reps; i++) mpz_clear(cand[i]);
+        free(cand);
+    }
+
+    // boundaries: small primes themselves, their squares, products across tiers
+    static const unsigned long small[] = {3, 5, 47, 53, 1021, 1031, 65521};
+    mpz_t n;
+    mpz_init(n);
+    for (size_t i = 0; i < sizeof small / sizeof small[0]; i++) {
+        mpz_set_ui(n, small[i]);
+        failed |= !trial_div_pass(n, NULL);
+        mpz_mul_ui(n, n, small[i]);
+        failed |= trial_div_pass(n, NULL);
+        mpz_set_ui(n, 65537);
+        mpz_mul_ui(n, n, small[i]);
+        failed |= trial_div_pass(n, NULL);
+    }
+    // squarefree products of small primes (gcd == n), e.g. Carmichael 561
+    static const unsigned long products[] = {15, 561, 3 * 53, 53 * 1031, 1031 * 65521};
+    for (size_t i = 0; i < sizeof products / sizeof products[0]; i++) {
+        mpz_set_ui(n, products[i]);
+        failed |= trial_div_pass(n, NULL);
+    }
+    mpz_set_ui(n, 65537);
+    mpz_mul_ui(n, n, 65539);
+    failed |= !trial_div_pass(n, NULL);      // no factor below 2^16: passes
+    mpz_clear(n);
+
+    printf("Result: %s\n", failed ? "MISMATCH" : "all verdicts match mpz_probab_prime_p");
+    gmp_randclear(rng);
+    return failed;
+}
+#endif /* CRYPTO_NO_MAIN */
@@ -0,0 +1,30 @@
+// trial_div.h
+// Small-factor prefilter for the primality tests.
+//
+// The odd primes below 2^16 are multiplied, once per process, into three
+// products: 3..47 (one limb), 53..1021 and 1031..65521. A candidate is
+// checked against them in that order with one mpz_gcd_ui / mpz_gcd each,
+// so the ~70% of random odd composites with a factor below 50 cost a single
+// word division, and almost every composite with a factor below 2^16 is
+// rejected before any modular exponentiation.
+
+#ifndef TRIAL_DIV_H
+#define TRIAL_DIV_H
+
+#include <gmp.h>
+
+#define TD_LIMIT 65536u         // primes below this bound are tried
+
+// Set to 0 to skip the prefilter in miller_rabin / solovay_strassen (benchmarks)
+extern int trial_div_enabled;
+
+// Builds the prime products now instead of on the first trial_div_pass
+// (keeps the one-time sieve out of per-candidate timings)
+void trial_div_init(void);
+
+// 0 if n has a prime factor below TD_LIMIT other than n itself, 1 otherwise.
+// Expects odd n > 2. For n < TD_LIMIT^2 a 1 means n is prime. tmp is a
+// scratch integer (NULL: one is allocated for the call).
+int trial_div_pass(const mpz_t n, mpz_ptr tmp);
+
+#endif /* TRIAL_DIV_H */
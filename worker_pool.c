@@ -0,0 +1,95 @@
+// worker_pool.c
+// Persistent worker threads for the batch engines (see worker_pool.h).
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "worker_pool.h"
+
+typedef struct {
+    WORKER_POOL *p;
+    int id;
+} WP_START;
+
+static void *wp_main(void *arg) {
+    WORKER_POOL *p = ((WP_START *)arg)->p;
+    int id = ((WP_START *)arg)->id;
+    free(arg);
+    unsigned long seen = 0;
+
+    for (;;) {
+        pthread_mutex_lock(&p->mu);
+        while (!p->shutdown && p->job == seen)
+            pthread_cond_wait(&p->job_cv, &p->mu);
+        if (p->shutdown) {
+            pthread_mutex_unlock(&p->mu);
+            return NULL;
+        }
+        seen = p->job;
+        pthread_mutex_unlock(&p->mu);
+
+        p->fn(p->arg, id);
+
+        pthread_mutex_lock(&p->mu);
+        if (--p->active == 0) pthread_cond_signal(&p->idle_cv);
+        pthread_mutex_unlock(&p->mu);
+    }
+}
+
+int worker_pool_size(int threads) {
+    if (threads <= 0) threads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    return threads > 0 ? threads : 1;
+}
+
+int worker_pool_start(WORKER_POOL *p, int threads, WORKER_POOL_FN fn, void *arg) {
+    p->nthreads = 0;
+    p->fn = fn;
+    p->arg = arg;
+    p->job = 0;
+    p->active = 0;
+    p->shutdown = 0;
+    if (!(p->tids = malloc((size_t)threads * sizeof *p->tids))) return 0;
+    pthread_mutex_init(&p->mu, NULL);
+    pthread_cond_init(&p->job_cv, NULL);
+    pthread_cond_init(&p->idle_cv, NULL);
+
+    // a partial pool still works: jobs just run on fewer threads
+    while (p->nthreads < threads) {
+        WP_START *st = malloc(sizeof *st);
+        if (!st) break;
+        st->p = p;
+        st->id = p->nthreads;
+        if (pthread_create(&p->tids[p->nthreads], NULL, wp_main, st) != 0) {
+            free(st);
+            break;
+        }
+        p->nthreads++;
+    }
+    if (p->nthreads == 0) worker_pool_stop(p);
+    return p->nthreads;
+}
+
+void worker_pool_stop(WORKER_POOL *p) {
+    pthread_mutex_lock(&p->mu);
+    p->shutdown = 1;
+    pthread_cond_broadcast(&p->job_cv);
+    pthread_mutex_unlock(&p->mu);
+
+    for (int i = 0; i < p->nthreads; i++) pthread_join(p->tids[i], NULL);
+    pthread_cond_destroy(&p->job_cv);
+    pthread_cond_destroy(&p->idle_cv);
+    pthread_mutex_destroy(&p->mu);
+    free(p->tids);
+    p->tids = NULL;
+    p->nthreads = 0;
+}
+
+void worker_pool_run(WORKER_POOL *p) {
+    pthread_mutex_lock(&p->mu);
+    p->active = p->nthreads;
+    p->job++;
+    pthread_cond_broadcast(&p->job_cv);
+    while (p->active > 0)
+        pthread_cond_wait(&p->idle_cv, &p->mu);
+    pthread_mutex_unlock(&p->mu);
+}
@@ -0,0 +1,47 @@
+// worker_pool.h
+// Persistent worker threads for the batch engines (rsa_keygen, rsa_batch,
+// prime_batch).
+//
+// The threads sleep on a condition variable between jobs. A job calls
+// fn(arg, id) once on every worker, id = 0 .. nthreads-1, and worker_pool_run
+// returns when all of those calls have returned. The engine keeps its
+// per-worker state in its own array indexed by id and publishes the job's
+// parameters before calling worker_pool_run; the pool mutex orders those
+// writes before the workers read them.
+
+#ifndef WORKER_POOL_H
+#define WORKER_POOL_H
+
+#include <pthread.h>
+
+typedef void (*WORKER_POOL_FN)(void *arg, int id);
+
+typedef struct {
+    int nthreads;
+    pthread_t *tids;
+    WORKER_POOL_FN fn;
+    void *arg;
+
+    pthread_mutex_t mu;
+    pthread_cond_t job_cv;      // new job or shutdown
+    pthread_cond_t idle_cv;     // all workers done with the job
+    unsigned long job;          // job counter
+    int active;                 // workers still inside the current job
+    int shutdown;
+} WORKER_POOL;
+
+// threads <= 0 means one per online CPU
+int worker_pool_size(int threads);
+
+// Starts up to `threads` workers and returns how many started; fewer than
+// asked if pthread_create failed part way. On 0 (nothing started or out of
+// memory) the pool holds no resources and must not be stopped.
+int worker_pool_start(WORKER_POOL *p, int threads, WORKER_POOL_FN fn, void *arg);
+
+// Joins the workers; the pool may be started again afterwards
+void worker_pool_stop(WORKER_POOL *p);
+
+// One job: fn(arg, id) on every worker, returns once they are all done
+void worker_pool_run(WORKER_POOL *p);
+
+#endif /* WORKER_POOL_H */